@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "mu-mips.h"
+
+__thread ff_state_t FF;
+int FF_FLAG = TRUE;
+
+/************************************************************/
+/* Iterations of a loop closed by branch <instruction> until it falls through,      */
+/* counting the next one as 1, when register r changes by delta[r] per iteration. */
+/* FF_INFINITE if it never exits, 0 if it can't be worked out                                */
+/************************************************************/
+uint64_t ff_trips(uint32_t instruction, const uint32_t *delta){
+	uint32_t opcode, rs, rt, a, b, diff, step, inverse;
+	int i, shift;
+
+	opcode = (instruction & 0xFC000000) >> 26;
+	rs = (instruction & 0x03E00000) >> 21;
+	rt = (instruction & 0x001F0000) >> 16;
+	a = CURRENT_STATE.REGS[rs];
+	b = CURRENT_STATE.REGS[rt];
+
+	switch(opcode){
+		case 0x02: //J
+			return FF_INFINITE;
+		case 0x04: //BEQ: keeps looping only while both sides move together
+			return delta[rs] == delta[rt] ? FF_INFINITE : 1;
+		case 0x05: //BNE: first j with (a - b) + j * (da - db) == 0 mod 2^32
+			diff = a - b;
+			step = delta[rs] - delta[rt];
+			if(step == 0){
+				return FF_INFINITE;
+			}
+			shift = __builtin_ctz(step);
+			if((-diff) & ((1u << shift) - 1)){
+				return FF_INFINITE; /* the difference never reaches zero */
+			}
+			step >>= shift;
+			inverse = step; /* Newton's iteration for the inverse of an odd number mod 2^32 */
+			for(i = 0; i < 5; i++){
+				inverse *= 2 - step * inverse;
+			}
+			diff = ((-diff) >> shift) * inverse;
+			if(shift > 0){
+				diff &= 0xFFFFFFFFu >> shift;
+			}
+			return diff ? diff : (1ULL << (32 - shift));
+		case 0x06: //BLEZ
+			return ff_signed_trips((int32_t)a, (int32_t)delta[rs], INT32_MIN, 0);
+		case 0x07: //BGTZ
+			return ff_signed_trips((int32_t)a, (int32_t)delta[rs], 1, INT32_MAX);
+		case 0x01:
+			if(rt == 0x00){ //BLTZ
+				return ff_signed_trips((int32_t)a, (int32_t)delta[rs], INT32_MIN, -1);
+			}
+			if(rt == 0x01){ //BGEZ
+				return ff_signed_trips((int32_t)a, (int32_t)delta[rs], 0, INT32_MAX);
+			}
+			return 0;
+		default:
+			return 0;
+	}
+}
+
+/************************************************************/
+/* Iterations until <value> + j * <delta> (32-bit wrapping) leaves [lo, hi]               */
+/************************************************************/
+uint64_t ff_signed_trips(int64_t value, int64_t delta, int64_t lo, int64_t hi){
+	uint64_t trips;
+
+	if(delta == 0){
+		return FF_INFINITE;
+	}
+	trips = delta > 0 ? (hi - value) / delta + 1 : (value - lo) / -delta + 1;
+	/* leaving the range by wrapping around could land back inside it */
+	value = (int32_t)(uint32_t)(value + (int64_t)trips * delta);
+	return value < lo || value > hi ? trips : 0;
+}
+
+/************************************************************/
+/* Called by run/runAll after executing the instruction at <branch_pc>. When it was */
+/* the backward branch of a loop whose body only steps counters (ADDI/ADDIU rX,  */
+/* rX, imm and NOPs), jump ahead to the loop's last iteration, or by as much of   */
+/* <budget> as fits. Sets *elided; FALSE if the loop can never exit (after            */
+/* skipping the budget, unless it is FF_UNLIMITED)                                                  */
+/************************************************************/
+int fast_forward(uint32_t branch_pc, uint32_t budget, uint32_t *elided){
+	uint32_t delta[32], instruction, head, target, opcode, rt, body, pc;
+	uint64_t trips, skip, v[OOO_NUM_VECTOR];
+	ff_loop_t *reject;
+	int i, steady, endless;
+
+	*elided = 0;
+	head = CURRENT_STATE.PC;
+	if(head > branch_pc || branch_pc - head >= FF_MAX_BODY * 4 || !FF_FLAG || TRACE_FLAG){
+		return TRUE;
+	}
+	reject = &FF.reject[(branch_pc >> 2) & (FF_REJECT_SIZE - 1)];
+	if(reject->branch == branch_pc && reject->head == head){
+		return TRUE;
+	}
+	for(i = 0; i < NUM_BREAKPOINTS; i++){
+		if(BREAKPOINTS[i] >= head && BREAKPOINTS[i] <= branch_pc){
+			return TRUE;
+		}
+	}
+
+	/* the loop: counter steps and NOPs, closed by a branch or jump back to the head */
+	body = (branch_pc - head) / 4 + 1;
+	memset(delta, 0, sizeof(delta));
+	for(pc = head; pc < branch_pc; pc += 4){
+		instruction = vmem_peek_32(pc);
+		opcode = (instruction & 0xFC000000) >> 26;
+		rt = (instruction & 0x001F0000) >> 16;
+		if(instruction == 0){
+			continue;
+		}
+		if((opcode != 0x08 && opcode != 0x09) || rt == 0 || ((instruction & 0x03E00000) >> 21) != rt){
+			break;
+		}
+		delta[rt] += (int16_t)(instruction & 0xFFFF);
+	}
+	instruction = vmem_peek_32(branch_pc);
+	opcode = (instruction & 0xFC000000) >> 26;
+	target = opcode == 0x02 ? (branch_pc & 0xF0000000) | ((instruction & 0x03FFFFFF) << 2) : branch_pc + ((uint32_t)(int16_t)(instruction & 0xFFFF) << 2);
+	trips = pc == branch_pc && target == head ? ff_trips(instruction, delta) : 0;
+	if(trips == 0){
+		reject->branch = branch_pc;
+		reject->head = head;
+		return TRUE;
+	}
+	endless = trips == FF_INFINITE && !(interrupts_enabled() && (CP0[CP0_STATUS] & STATUS_IM7));
+	if(endless && budget == FF_UNLIMITED){
+		FF.spins++;
+		printf("Loop at 0x%08x-0x%08x can never exit; stopping.\n", head, branch_pc);
+		return FALSE;
+	}
+
+	/* the timing model is only extrapolated once the loop's per-iteration effect on it */
+	/* has repeated long enough to cover everything still in flight                              */
+	if(OOO_MODEL != NULL){
+		ooo_vector(v);
+		if(FF.loop.branch != branch_pc || FF.loop.head != head){
+			FF.loop.branch = branch_pc;
+			FF.loop.head = head;
+			FF.steady = 0;
+			memset(FF.delta, 0, sizeof(FF.delta));
+			memcpy(FF.last, v, sizeof(v));
+			return TRUE;
+		}
+		steady = TRUE;
+		for(i = 0; i < OOO_NUM_VECTOR; i++){
+			if(v[i] - FF.last[i] != FF.delta[i]){
+				steady = FALSE;
+			}
+			FF.delta[i] = v[i] - FF.last[i];
+		}
+		memcpy(FF.last, v, sizeof(v));
+		steady = steady && FF.delta[OOO_V_FETCH] == FF.delta[OOO_V_COMMIT] && FF.delta[OOO_V_DISPATCH] == FF.delta[OOO_V_COMMIT] &&
+			FF.delta[OOO_V_FETCH_COUNT] == 0 && FF.delta[OOO_V_DISPATCH_COUNT] == 0 && FF.delta[OOO_V_COMMIT_COUNT] == 0 && FF.delta[OOO_V_RS_COUNT] == 0;
+		FF.steady = steady ? FF.steady + 1 : 0;
+		if(FF.steady < OOO_CONFIG.rob_size / body + 4){
+			return TRUE;
+		}
+	}
+
+	/* run up to, not through, the final iteration so the exit executes normally */
+	skip = trips == FF_INFINITE ? budget / body : trips - 1;
+	if(skip > budget / body) skip = budget / body;
+	/* stop where the timer next needs looking at, so interrupts arrive on time */
+	if(TIMER_EVENT <= INSTRUCTION_COUNT) skip = 0;
+	else if(skip > (TIMER_EVENT - INSTRUCTION_COUNT) / body) skip = (TIMER_EVENT - INSTRUCTION_COUNT) / body;
+	if(skip == 0){
+		return !endless;
+	}
+
+	if(JOURNAL != NULL){
+		/* one journal step stands for the whole skip */
+		journal_push(NULL, CURRENT_STATE.PC);
+		journal_push(JOURNAL_SKIP, skip * body - 1);
+		JOURNAL->steps += skip * body;
+	}
+	for(i = 1; i < 32; i++){
+		if(delta[i] != 0){
+			if(JOURNAL != NULL){
+				journal_push((uint8_t *)&CURRENT_STATE.REGS[i], CURRENT_STATE.REGS[i]);
+			}
+			CURRENT_STATE.REGS[i] += (uint32_t)skip * delta[i];
+		}
+	}
+	NEXT_STATE = CURRENT_STATE;
+	INSTRUCTION_COUNT += skip * body;
+	if(OOO_MODEL != NULL){
+		ooo_advance(skip, FF.delta);
+		for(i = 0; i < OOO_NUM_VECTOR; i++){
+			FF.last[i] += skip * FF.delta[i];
+		}
+		FF.timed += skip * body;
+	}
+	if(INSTRUCTION_COUNT >= NEXT_EVENT){
+		event_dispatch();
+	}
+	FF.skips++;
+	FF.elided += skip * body;
+	*elided = skip * body;
+	return !endless;
+}
+
+/************************************************************/
+/* Loop fast-forward report                                                                                */
+/************************************************************/
+void ff_report(){
+	printf("-------------------------------------------------------------\n");
+	printf("Loop fast-forward %s%s\n", FF_FLAG ? "on" : "off", FF_FLAG && TRACE_FLAG ? " (inactive while tracing)" : "");
+	printf("-------------------------------------------------------------\n");
+	printf("loops skipped\t\t: %llu\n", (unsigned long long)FF.skips);
+	printf("instructions elided\t: %llu (%.1f%% of %llu executed)\n", (unsigned long long)FF.elided,
+		INSTRUCTION_COUNT ? 100.0 * FF.elided / INSTRUCTION_COUNT : 0.0, (unsigned long long)INSTRUCTION_COUNT);
+	printf("timing extrapolated\t: %llu instructions\n", (unsigned long long)FF.timed);
+	printf("endless loops stopped\t: %llu\n", (unsigned long long)FF.spins);
+	printf("-------------------------------------------------------------\n\n");
+}
@@ -0,0 +1,428 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+#include <fenv.h>
+#include <math.h>
+
+#include "mu-mips.h"
+
+__thread uint32_t FPR[FPU_REGS];
+__thread uint32_t FCSR;
+int FPU_STRICT;
+__thread fpu_stats_t FPU_STATS;
+
+/***************************************************************/
+/* Power-on FPU: registers and FCSR clear, round to nearest           */
+/***************************************************************/
+void fpu_reset()
+{
+	memset(FPR, 0, sizeof(FPR));
+	FCSR = 0;
+	memset(&FPU_STATS, 0, sizeof(FPU_STATS));
+	feclearexcept(FE_ALL_EXCEPT);
+}
+
+/***************************************************************/
+/* FPE_* bits for a set of host FE_* exception flags                          */
+/***************************************************************/
+static inline uint32_t fpu_host_flags(int host)
+{
+	return ((host & FE_INEXACT) ? FPE_I : 0) | ((host & FE_UNDERFLOW) ? FPE_U : 0) | ((host & FE_OVERFLOW) ? FPE_O : 0) |
+		((host & FE_DIVBYZERO) ? FPE_Z : 0) | ((host & FE_INVALID) ? FPE_V : 0);
+}
+
+/***************************************************************/
+/* Fold the host's sticky flags, raised by fast-path instructions, into */
+/* FCSR Flags; anything reading or saving FCSR calls this first            */
+/***************************************************************/
+void fpu_sync()
+{
+	int host = fetestexcept(FE_ALL_EXCEPT);
+
+	if (host) {
+		FCSR |= fpu_host_flags(host) << FCSR_FLAGS_SHIFT;
+		feclearexcept(FE_ALL_EXCEPT);
+	}
+}
+
+/***************************************************************/
+/* Coprocessor Unusable unless Status.CU1 is set                              */
+/***************************************************************/
+int fpu_usable()
+{
+	if (CP0[CP0_STATUS] & STATUS_CU1) {
+		return TRUE;
+	}
+	raise_exception(EXC_CPU, 0, FALSE);
+	cp0_set(CP0_CAUSE, (CP0[CP0_CAUSE] & ~CAUSE_CE) | (1 << 28));
+	return FALSE;
+}
+
+static inline float fpr_s(int r)
+{
+	float f;
+	memcpy(&f, &FPR[r], sizeof(f));
+	return f;
+}
+
+static inline double fpr_d(int r)
+{
+	uint64_t bits = ((uint64_t)FPR[r + 1] << 32) | FPR[r];
+	double d;
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+/* NaN tests on the bits, so looking doesn't raise host flags; MIPS NaNs */
+/* with the top fraction bit set are signalling (the host's quiet ones)   */
+static inline int fpu_nan_s(uint32_t bits)
+{
+	return (bits & 0x7F800000) == 0x7F800000 && (bits & 0x007FFFFF);
+}
+
+static inline int fpu_nan_d(uint32_t lo, uint32_t hi)
+{
+	return (hi & 0x7FF00000) == 0x7FF00000 && ((hi & 0x000FFFFF) || lo);
+}
+
+static inline int fpu_snan_s(uint32_t bits)
+{
+	return (bits & 0x7FC00000) == 0x7FC00000;
+}
+
+static inline int fpu_snan_d(uint32_t hi)
+{
+	return (hi & 0x7FF80000) == 0x7FF80000;
+}
+
+/***************************************************************/
+/* Round to an integer by FCSR mode <rm> (ROUND/TRUNC/CEIL/FLOOR fix  */
+/* it, CVT.W uses FCSR); out of range or NaN is Invalid, 2^31-1           */
+/***************************************************************/
+static uint32_t fpu_to_word(double x, int rm, uint32_t *flags)
+{
+	double r;
+
+	switch (rm) {
+		case 0:
+			r = floor(x);
+			if (x - r > 0.5 || (x - r == 0.5 && fmod(r, 2.0) != 0.0)) {
+				r += 1.0;
+			}
+			break;
+		case 1:
+			r = trunc(x);
+			break;
+		case 2:
+			r = ceil(x);
+			break;
+		default:
+			r = floor(x);
+			break;
+	}
+	if (!(r >= -2147483648.0 && r <= 2147483647.0)) {
+		*flags |= FPE_V;
+		return 0x7FFFFFFF;
+	}
+	if (r != x) {
+		*flags |= FPE_I;
+	}
+	return (uint32_t)(int32_t)r;
+}
+
+/***************************************************************/
+/* COP1 arithmetic, conversions and compares (rs is the format).            */
+/* The fast path runs the host's SSE2 operation and leaves its flags     */
+/* sticky on the host; FCSR Cause isn't maintained there. When FCSR sets */
+/* a directed rounding mode or enables a trap (or FPU_STRICT), or an      */
+/* operand is a NaN (the host would flag a MIPS quiet NaN as signalling), */
+/* the strict path sets the host rounding mode, computes Cause exactly,  */
+/* applies MIPS signalling-NaN rules and traps before the result is written.*/
+/***************************************************************/
+void fpu_arith(uint32_t instruction)
+{
+	static const int host_rounding[4] = { FE_TONEAREST, FE_TOWARDZERO, FE_UPWARD, FE_DOWNWARD };
+	uint32_t fmt, ft, fs, fd, function, flags = 0, cause, result_lo = 0, result_hi = 0, cond = 0;
+	int strict, to_double = FALSE, nan_in, snan_in;
+	volatile double a = 0, b = 0, dr = 0;
+	volatile float sa = 0, sb = 0, sr = 0;
+
+	fmt = (instruction & 0x03E00000) >> 21;
+	ft = (instruction & 0x001F0000) >> 16;
+	fs = (instruction & 0x0000F800) >> 11;
+	fd = (instruction & 0x000007C0) >> 6;
+	function = instruction & 0x0000003F;
+
+	/* doubles need even registers; W only converts */
+	if ((fmt == FMT_D && ((fs | ft | fd) & 1)) || (function == 0x21 && (fd & 1)) || (fmt == FMT_W && function != 0x20 && function != 0x21)) {
+		FAULT_FLAG = FAULT_ILLEGAL;
+		FAULT_ADDR = CURRENT_STATE.PC;
+		return;
+	}
+
+	if (fmt == FMT_D) {
+		a = fpr_d(fs);
+		b = fpr_d(ft);
+		nan_in = fpu_nan_d(FPR[fs], FPR[fs + 1]) || ((function < 0x04 || function >= 0x30) && fpu_nan_d(FPR[ft], FPR[ft + 1]));
+		snan_in = fpu_snan_d(FPR[fs + 1]) || ((function < 0x04 || function >= 0x30) && fpu_snan_d(FPR[ft + 1]));
+	}
+	else {
+		sa = fpr_s(fs);
+		sb = fpr_s(ft);
+		nan_in = fmt == FMT_S && (fpu_nan_s(FPR[fs]) || ((function < 0x04 || function >= 0x30) && fpu_nan_s(FPR[ft])));
+		snan_in = fmt == FMT_S && (fpu_snan_s(FPR[fs]) || ((function < 0x04 || function >= 0x30) && fpu_snan_s(FPR[ft])));
+	}
+
+	strict = FPU_STRICT || (FCSR & (FCSR_RM | FCSR_ENABLES)) || nan_in;
+	if (strict) {
+		fpu_sync();
+		fesetround(host_rounding[FCSR & FCSR_RM]);
+		FPU_STATS.strict++;
+	}
+	else {
+		FPU_STATS.fast++;
+	}
+
+	switch (function) {
+		case 0x00: //ADD
+		case 0x01: //SUB
+		case 0x02: //MUL
+		case 0x03: //DIV
+		case 0x04: //SQRT
+			if (fmt == FMT_D) {
+				dr = function == 0x00 ? a + b : function == 0x01 ? a - b : function == 0x02 ? a * b : function == 0x03 ? a / b : sqrt(a);
+				to_double = TRUE;
+			}
+			else {
+				sr = function == 0x00 ? sa + sb : function == 0x01 ? sa - sb : function == 0x02 ? sa * sb : function == 0x03 ? sa / sb : sqrtf(sa);
+			}
+			break;
+		case 0x05: //ABS
+		case 0x06: //MOV
+		case 0x07: //NEG
+			result_lo = FPR[fs];
+			result_hi = fmt == FMT_D ? FPR[fs + 1] : 0;
+			if (function != 0x06) {
+				if (fmt == FMT_D) {
+					result_hi = function == 0x05 ? result_hi & 0x7FFFFFFF : result_hi ^ 0x80000000;
+				}
+				else {
+					result_lo = function == 0x05 ? result_lo & 0x7FFFFFFF : result_lo ^ 0x80000000;
+				}
+			}
+			nan_in = FALSE; /* a sign-bit change, even on a NaN */
+			break;
+		case 0x0C: //ROUND.W
+		case 0x0D: //TRUNC.W
+		case 0x0E: //CEIL.W
+		case 0x0F: //FLOOR.W
+		case 0x24: //CVT.W
+			result_lo = fpu_to_word(fmt == FMT_D ? a : (double)sa, function == 0x24 ? (FCSR & FCSR_RM) : (function & 3), &flags);
+			nan_in = FALSE;
+			break;
+		case 0x20: //CVT.S
+			if (fmt == FMT_S) {
+				goto unimplemented;
+			}
+			sr = fmt == FMT_D ? (float)a : (float)(int32_t)FPR[fs];
+			break;
+		case 0x21: //CVT.D
+			if (fmt == FMT_D) {
+				goto unimplemented;
+			}
+			dr = fmt == FMT_S ? (double)sa : (double)(int32_t)FPR[fs];
+			to_double = TRUE;
+			break;
+		default:
+			if (function < 0x30) {
+				goto unimplemented;
+			}
+			/* C.cond: bit 3 signals on any NaN, bits 2..0 are less, equal, unordered */
+			cond = function & 0xF;
+			if (fmt == FMT_S) {
+				a = sa;
+				b = sb;
+			}
+			flags |= nan_in && ((cond & 8) || snan_in) ? FPE_V : 0;
+			cond = ((cond & 4) && a < b) || ((cond & 2) && a == b) || ((cond & 1) && nan_in);
+			break;
+	}
+
+	if (to_double) {
+		uint64_t bits;
+		double d = dr;
+		memcpy(&bits, &d, sizeof(bits));
+		if (d != d) {
+			bits = FPU_NAN_D;
+		}
+		result_lo = (uint32_t)bits;
+		result_hi = (uint32_t)(bits >> 32);
+	}
+	else if (function <= 0x04 || function == 0x20) {
+		float f = sr;
+		memcpy(&result_lo, &f, sizeof(result_lo));
+		if (f != f) {
+			result_lo = FPU_NAN_S;
+		}
+	}
+
+	if (strict) {
+		cause = flags | fpu_host_flags(fetestexcept(FE_ALL_EXCEPT));
+		if (nan_in) {
+			/* the host signals on what it takes for a signalling NaN */
+			cause = (cause & ~FPE_V) | (flags & FPE_V) | (snan_in ? FPE_V : 0);
+		}
+		feclearexcept(FE_ALL_EXCEPT);
+		fesetround(FE_TONEAREST);
+		FCSR = (FCSR & ~FCSR_CAUSE) | (cause << FCSR_CAUSE_SHIFT);
+		if (cause & (((FCSR & FCSR_ENABLES) >> FCSR_ENABLES_SHIFT) | FPE_E)) {
+			FPU_STATS.traps++;
+			raise_exception(EXC_FPE, 0, FALSE);
+			return;
+		}
+		flags = cause;
+	}
+	FCSR |= flags << FCSR_FLAGS_SHIFT;
+
+	if (function >= 0x30) {
+		FCSR = cond ? FCSR | FCSR_C : FCSR & ~FCSR_C;
+		return;
+	}
+	FPR[fd] = result_lo;
+	if (to_double || (fmt == FMT_D && function <= 0x07)) {
+		FPR[fd + 1] = result_hi;
+	}
+	return;
+
+unimplemented:
+	/* Cause.E always traps */
+	if (strict) {
+		feclearexcept(FE_ALL_EXCEPT);
+		fesetround(FE_TONEAREST);
+	}
+	FCSR = (FCSR & ~FCSR_CAUSE) | (FPE_E << FCSR_CAUSE_SHIFT);
+	FPU_STATS.traps++;
+	raise_exception(EXC_FPE, 0, FALSE);
+}
+
+/***************************************************************/
+/* Execute a COP1 instruction; TRUE if it redirected the PC (BC1T/F)    */
+/***************************************************************/
+int handle_cop1(uint32_t instruction)
+{
+	uint32_t rs, rt, fs, immediate, value;
+
+	rs = (instruction & 0x03E00000) >> 21;
+	rt = (instruction & 0x001F0000) >> 16;
+	fs = (instruction & 0x0000F800) >> 11;
+	immediate = instruction & 0x0000FFFF;
+
+	if (!fpu_usable()) {
+		return FALSE;
+	}
+	switch (rs) {
+		case 0x00: //MFC1
+			NEXT_STATE.REGS[rt] = FPR[fs];
+			break;
+		case 0x02: //CFC1
+			fpu_sync();
+			NEXT_STATE.REGS[rt] = fs == 0 ? FIR_R4400 : (fs == 31 ? FCSR : 0);
+			break;
+		case 0x04: //MTC1
+			FPR[fs] = CURRENT_STATE.REGS[rt];
+			break;
+		case 0x06: //CTC1
+			if (fs != 31) {
+				break;
+			}
+			fpu_sync();
+			value = CURRENT_STATE.REGS[rt] & FCSR_WRITABLE;
+			FCSR = value;
+			/* writing a Cause bit whose Enable is set traps, as on the R4000 */
+			if (((value & FCSR_CAUSE) >> FCSR_CAUSE_SHIFT) & (((value & FCSR_ENABLES) >> FCSR_ENABLES_SHIFT) | FPE_E)) {
+				FPU_STATS.traps++;
+				raise_exception(EXC_FPE, 0, FALSE);
+			}
+			break;
+		case 0x08: //BC1F, BC1T (BC1FL/BC1TL: there is no delay slot to nullify)
+			if (((FCSR & FCSR_C) != 0) == (rt & 1)) {
+				NEXT_STATE.PC = CURRENT_STATE.PC + ((immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) << 2 : (immediate & 0x0000FFFF) << 2);
+				return TRUE;
+			}
+			break;
+		case FMT_S:
+		case FMT_D:
+		case FMT_W:
+			fpu_arith(instruction);
+			break;
+		default:
+			FAULT_FLAG = FAULT_ILLEGAL;
+			FAULT_ADDR = CURRENT_STATE.PC;
+			break;
+	}
+	return FALSE;
+}
+
+/***************************************************************/
+/* FP registers, FCSR and path counts                                                             */
+/***************************************************************/
+void fpu_report()
+{
+	static const char *modes[] = { "RN", "RZ", "RP", "RM" };
+	static const char *bits = "IUOZVE";
+	float f;
+	int i, j;
+
+	fpu_sync();
+	printf("-------------------------------------------------------------\n");
+	printf("FCSR\t: 0x%08x (%s, C=%d, flags ", FCSR, modes[FCSR & FCSR_RM], (FCSR & FCSR_C) != 0);
+	for (j = 0; j < 5; j++) {
+		printf("%c", (FCSR >> (FCSR_FLAGS_SHIFT + j)) & 1 ? bits[j] : '-');
+	}
+	printf(", enables ");
+	for (j = 0; j < 5; j++) {
+		printf("%c", (FCSR >> (FCSR_ENABLES_SHIFT + j)) & 1 ? bits[j] : '-');
+	}
+	printf(", cause ");
+	for (j = 0; j < 6; j++) {
+		printf("%c", (FCSR >> (FCSR_CAUSE_SHIFT + j)) & 1 ? bits[j] : '-');
+	}
+	printf(")\n");
+	printf("path\t: %llu fast, %llu strict%s, %llu traps\n", (unsigned long long)FPU_STATS.fast, (unsigned long long)FPU_STATS.strict,
+		FPU_STRICT ? " (forced)" : "", (unsigned long long)FPU_STATS.traps);
+	printf("-------------------------------------------------------------\n");
+	printf("[Register]\t[Value]\t\t[Single]\t[Double]\n");
+	for (i = 0; i < FPU_REGS; i++) {
+		memcpy(&f, &FPR[i], sizeof(f));
+		printf("[F%d]\t\t0x%08x\t%-12g", i, FPR[i], f);
+		if (!(i & 1)) {
+			printf("\t%.17g", fpr_d(i));
+		}
+		printf("\n");
+	}
+	printf("-------------------------------------------------------------\n\n");
+}
+
+/***************************************************************/
+/* fpu regs|strict|auto                                                                                      */
+/***************************************************************/
+void fpu_command()
+{
+	char command[20];
+
+	if (scanf("%19s", command) != 1) {
+		return;
+	}
+	if (strcasecmp(command, "regs") == 0) {
+		fpu_report();
+	}
+	else if (strcasecmp(command, "strict") == 0 || strcasecmp(command, "auto") == 0) {
+		FPU_STRICT = strcasecmp(command, "strict") == 0;
+		printf("FPU %s.\n\n", FPU_STRICT ? "always on the strict path" : "on the fast path unless FCSR needs the strict one");
+	}
+	else {
+		printf("Usage: fpu regs|strict|auto\n\n");
+	}
+}
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "mu-mips.h"
+
+__thread uint8_t *COVERAGE_MAP;
+fuzz_state_t FUZZ;
+
+/************************************************************/
+/* Small per-worker PRNG (xorshift64*)                                                                  */
+/************************************************************/
+uint64_t fuzz_rand(uint64_t *state){
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/************************************************************/
+/* Apply a stack of random havoc mutations to <in>                                            */
+/************************************************************/
+void fuzz_mutate(fuzz_input_t *in, uint64_t *rng){
+	static const int8_t interesting_8[] = { -128, -1, 0, 1, 16, 32, 64, 100, 127 };
+	static const int32_t interesting_32[] = { -2147483647 - 1, -100663046, -32769, -32768, -129, -128, -1, 0, 1, 16, 32, 64, 100, 127, 128, 255, 256, 512, 1000, 1024, 4096, 32767, 32768, 65535, 65536, 100663045, 2147483647 };
+	uint32_t stack, pos, len, other, size;
+	int32_t value;
+
+	stack = 1 << (fuzz_rand(rng) % 4);
+	while (stack--) {
+		if (in->len == 0) {
+			in->len = 1;
+			in->data[0] = 0;
+		}
+		pos = fuzz_rand(rng) % in->len;
+		switch (fuzz_rand(rng) % 9) {
+			case 0: /* flip a bit */
+				in->data[pos] ^= 1 << (fuzz_rand(rng) % 8);
+				break;
+			case 1: /* random byte */
+				in->data[pos] = fuzz_rand(rng);
+				break;
+			case 2: /* interesting byte */
+				in->data[pos] = interesting_8[fuzz_rand(rng) % sizeof(interesting_8)];
+				break;
+			case 3: /* interesting word, little endian like guest memory */
+				if (in->len < 4) break;
+				pos = fuzz_rand(rng) % (in->len - 3);
+				value = interesting_32[fuzz_rand(rng) % (sizeof(interesting_32) / sizeof(int32_t))];
+				memcpy(&in->data[pos], &value, 4);
+				break;
+			case 4: /* small byte arithmetic */
+				in->data[pos] += (int)(fuzz_rand(rng) % 35) - 17;
+				break;
+			case 5: /* small word arithmetic */
+				if (in->len < 4) break;
+				pos = fuzz_rand(rng) % (in->len - 3);
+				memcpy(&value, &in->data[pos], 4);
+				value += (int)(fuzz_rand(rng) % 35) - 17;
+				memcpy(&in->data[pos], &value, 4);
+				break;
+			case 6: /* delete a block */
+				if (in->len < 2) break;
+				len = 1 + fuzz_rand(rng) % (in->len - pos);
+				if (len >= in->len) len = in->len - 1;
+				memmove(&in->data[pos], &in->data[pos + len], in->len - pos - len);
+				in->len -= len;
+				break;
+			case 7: /* duplicate a block */
+				if (in->len >= FUZZ_MAX_INPUT) break;
+				len = 1 + fuzz_rand(rng) % (in->len - pos);
+				if (len > FUZZ_MAX_INPUT - in->len) len = FUZZ_MAX_INPUT - in->len;
+				memmove(&in->data[pos + len], &in->data[pos], in->len - pos);
+				in->len += len;
+				break;
+			case 8: /* splice in a chunk of another corpus entry */
+				size = __atomic_load_n(&FUZZ.corpus_size, __ATOMIC_ACQUIRE);
+				other = fuzz_rand(rng) % size;
+				if (FUZZ.corpus[other].len == 0) break;
+				len = 1 + fuzz_rand(rng) % FUZZ.corpus[other].len;
+				if (len > in->len - pos) len = in->len - pos;
+				memcpy(&in->data[pos], FUZZ.corpus[other].data, len);
+				break;
+		}
+	}
+}
+
+/************************************************************/
+/* Run the program once on <in>, starting from the <base> image                      */
+/************************************************************/
+int fuzz_exec(const fuzz_input_t *in, const mem_snapshot_t *base){
+	uint32_t i, word, pc;
+
+	mem_snapshot_restore(base);
+	memset(&CURRENT_STATE, 0, sizeof(CURRENT_STATE));
+	CURRENT_STATE.PC = MEM_TEXT_BEGIN;
+
+	/*input goes to the start of the data segment: $a0 = address, $a1 = length, $a2/$a3 = first two words*/
+	for (i = 0; i < in->len; i += 4) {
+		word = 0;
+		memcpy(&word, &in->data[i], in->len - i < 4 ? in->len - i : 4);
+		mem_write_32(FUZZ_INPUT_ADDR + i, word);
+		if (i < 8) {
+			CURRENT_STATE.REGS[6 + i / 4] = word;
+		}
+	}
+	CURRENT_STATE.REGS[4] = FUZZ_INPUT_ADDR;
+	CURRENT_STATE.REGS[5] = in->len;
+
+	NEXT_STATE = CURRENT_STATE;
+	RUN_FLAG = TRUE;
+	INSTRUCTION_COUNT = 0;
+	FAULT_FLAG = FAULT_NONE;
+	cp0_reset();
+	fpu_reset();
+	memset(COVERAGE_MAP, 0, FUZZ_MAP_SIZE);
+
+	while (RUN_FLAG) {
+		if (INSTRUCTION_COUNT >= FUZZ_EXEC_LIMIT) {
+			return FUZZ_TIMEOUT;
+		}
+		pc = CURRENT_STATE.PC;
+		cycle();
+		if (FAULT_FLAG != FAULT_NONE) {
+			CURRENT_STATE.PC = pc; /*report the faulting instruction, not its successor*/
+			return FUZZ_CRASH;
+		}
+	}
+	return FUZZ_OK;
+}
+
+/************************************************************/
+/* Map a raw hit count onto its AFL-style bucket bit                                          */
+/************************************************************/
+uint8_t fuzz_bucket(uint8_t hits){
+	if (hits <= 2) return hits;
+	if (hits == 3) return 4;
+	if (hits <= 7) return 8;
+	if (hits <= 15) return 16;
+	if (hits <= 31) return 32;
+	if (hits <= 127) return 64;
+	return 128;
+}
+
+/************************************************************/
+/* Merge this exec's coverage into the global map; TRUE if anything was new.         */
+/* The fetch-or makes the worker whose bucket bit lands first the one that saves it  */
+/************************************************************/
+int fuzz_new_coverage(){
+	uint64_t *words = (uint64_t *)COVERAGE_MAP;
+	uint32_t i, j;
+	uint8_t bucket, old;
+	int found = FALSE;
+
+	for (i = 0; i < FUZZ_MAP_SIZE / 8; i++) {
+		if (words[i] == 0) continue;
+		for (j = i * 8; j < i * 8 + 8; j++) {
+			if (COVERAGE_MAP[j] == 0) continue;
+			bucket = fuzz_bucket(COVERAGE_MAP[j]);
+			if (!(bucket & ~__atomic_load_n(&FUZZ.virgin[j], __ATOMIC_RELAXED))) continue;
+			old = __atomic_fetch_or(&FUZZ.virgin[j], bucket, __ATOMIC_RELAXED);
+			if (bucket & ~old) {
+				if (old == 0) {
+					__atomic_fetch_add(&FUZZ.edges, 1, __ATOMIC_RELAXED);
+				}
+				found = TRUE;
+			}
+		}
+	}
+	return found;
+}
+
+/************************************************************/
+/* Append <in> to the shared corpus                                                                     */
+/************************************************************/
+void fuzz_add_corpus(const fuzz_input_t *in){
+	pthread_mutex_lock(&FUZZ.lock);
+	if (FUZZ.corpus_size < FUZZ_MAX_CORPUS) {
+		FUZZ.corpus[FUZZ.corpus_size] = *in;
+		__atomic_store_n(&FUZZ.corpus_size, FUZZ.corpus_size + 1, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&FUZZ.lock);
+}
+
+/************************************************************/
+/* Write a crash or timeout input to FUZZ_OUT_DIR, once per (kind, pc)               */
+/************************************************************/
+void fuzz_save_artifact(const fuzz_input_t *in, int result){
+	static const char *fault_names[] = { "none", "unmapped", "unaligned", "illegal", "exception" };
+	char path[128];
+	uint64_t key;
+	uint32_t i;
+	FILE *fp;
+
+	key = ((uint64_t)(result == FUZZ_TIMEOUT ? 0xFF : FAULT_FLAG) << 32) | CURRENT_STATE.PC;
+	pthread_mutex_lock(&FUZZ.lock);
+	if (result == FUZZ_TIMEOUT) {
+		FUZZ.timeouts++;
+	}
+	else {
+		FUZZ.crashes++;
+	}
+	for (i = 0; i < FUZZ.num_artifacts; i++) {
+		if (FUZZ.artifacts[i] == key) break;
+	}
+	if (i < FUZZ.num_artifacts || FUZZ.num_artifacts == FUZZ_MAX_ARTIFACTS) {
+		pthread_mutex_unlock(&FUZZ.lock);
+		return;
+	}
+	FUZZ.artifacts[FUZZ.num_artifacts++] = key;
+	pthread_mutex_unlock(&FUZZ.lock);
+
+	if (result == FUZZ_TIMEOUT) {
+		snprintf(path, sizeof(path), "%s/timeouts/timeout-pc-%08x", FUZZ_OUT_DIR, CURRENT_STATE.PC);
+	}
+	else {
+		snprintf(path, sizeof(path), "%s/crashes/%s-pc-%08x-addr-%08x", FUZZ_OUT_DIR, fault_names[FAULT_FLAG], CURRENT_STATE.PC, FAULT_ADDR);
+	}
+	fp = fopen(path, "wb");
+	if (fp == NULL) {
+		printf("Error: Can't write fuzz artifact %s\n", path);
+		return;
+	}
+	fwrite(in->data, 1, in->len, fp);
+	fclose(fp);
+}
+
+/************************************************************/
+/* Fuzzing worker: owns a private machine, loops mutate/exec/triage                   */
+/************************************************************/
+void *fuzz_worker(void *arg){
+	fuzz_worker_t *worker = arg;
+	mem_snapshot_t base;
+	fuzz_input_t input;
+	uint32_t size;
+	int result;
+
+	TRACE_FLAG = FALSE;
+	QUIET_FLAG = TRUE;
+	init_memory();
+	load_program();
+	mem_snapshot_take(&base);
+	COVERAGE_MAP = calloc(FUZZ_MAP_SIZE, 1);
+	assert(COVERAGE_MAP != NULL);
+
+	while (!__atomic_load_n(&FUZZ.stop, __ATOMIC_RELAXED)) {
+		size = __atomic_load_n(&FUZZ.corpus_size, __ATOMIC_ACQUIRE);
+		input = FUZZ.corpus[fuzz_rand(&worker->seed) % size];
+		fuzz_mutate(&input, &worker->seed);
+
+		result = fuzz_exec(&input, &base);
+		__atomic_store_n(&worker->execs, worker->execs + 1, __ATOMIC_RELAXED);
+		if (result != FUZZ_OK) {
+			fuzz_save_artifact(&input, result);
+		}
+		else if (fuzz_new_coverage()) {
+			fuzz_add_corpus(&input);
+		}
+	}
+
+	free(COVERAGE_MAP);
+	COVERAGE_MAP = NULL;
+	mem_snapshot_free(&base);
+	free_memory();
+	return NULL;
+}
+
+/************************************************************/
+/* Seed the corpus from FUZZ_IN_DIR, or with a single zero input                         */
+/************************************************************/
+void fuzz_load_seeds(){
+	char path[512];
+	struct dirent *entry;
+	DIR *dir;
+	FILE *fp;
+	fuzz_input_t *in;
+
+	dir = opendir(FUZZ_IN_DIR);
+	while (dir != NULL && (entry = readdir(dir)) != NULL && FUZZ.corpus_size < FUZZ_MAX_CORPUS) {
+		if (entry->d_name[0] == '.') continue;
+		snprintf(path, sizeof(path), "%s/%s", FUZZ_IN_DIR, entry->d_name);
+		fp = fopen(path, "rb");
+		if (fp == NULL) continue;
+		in = &FUZZ.corpus[FUZZ.corpus_size];
+		in->len = fread(in->data, 1, FUZZ_MAX_INPUT, fp);
+		fclose(fp);
+		FUZZ.corpus_size++;
+	}
+	if (dir != NULL) {
+		closedir(dir);
+	}
+	if (FUZZ.corpus_size == 0) {
+		FUZZ.corpus[0].len = 16;
+		memset(FUZZ.corpus[0].data, 0, 16);
+		FUZZ.corpus_size = 1;
+	}
+}
+
+/************************************************************/
+/* Fuzz the loaded program for <seconds> on <num_workers> threads                        */
+/************************************************************/
+void fuzz(int seconds, int num_workers){
+	fuzz_worker_t workers[FUZZ_MAX_WORKERS];
+	uint64_t execs = 0;
+	int i, elapsed;
+
+	if (num_workers < 1 || num_workers > FUZZ_MAX_WORKERS || seconds < 1) {
+		printf("Usage: fuzz <seconds> <workers (1-%d)>\n\n", FUZZ_MAX_WORKERS);
+		return;
+	}
+
+	memset(&FUZZ, 0, sizeof(FUZZ));
+	pthread_mutex_init(&FUZZ.lock, NULL);
+	FUZZ.corpus = malloc(FUZZ_MAX_CORPUS * sizeof(fuzz_input_t));
+	assert(FUZZ.corpus != NULL);
+	fuzz_load_seeds();
+	mkdir(FUZZ_OUT_DIR, 0755);
+	mkdir(FUZZ_OUT_DIR "/crashes", 0755);
+	mkdir(FUZZ_OUT_DIR "/timeouts", 0755);
+
+	printf("Fuzzing %s for %d seconds on %d workers (%u seeds)...\n\n", prog_file, seconds, num_workers, FUZZ.corpus_size);
+	for (i = 0; i < num_workers; i++) {
+		workers[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1) ^ (uint64_t)time(NULL);
+		workers[i].execs = 0;
+		pthread_create(&workers[i].thread, NULL, fuzz_worker, &workers[i]);
+	}
+
+	for (elapsed = 1; elapsed <= seconds; elapsed++) {
+		sleep(1);
+		execs = 0;
+		for (i = 0; i < num_workers; i++) {
+			execs += __atomic_load_n(&workers[i].execs, __ATOMIC_RELAXED);
+		}
+		pthread_mutex_lock(&FUZZ.lock);
+		printf("[fuzz %ds] execs %llu (%llu/s, %llu/s per worker)  corpus %u  edges %u  crashes %u  timeouts %u\n", elapsed,
+			(unsigned long long)execs, (unsigned long long)(execs / elapsed), (unsigned long long)(execs / elapsed / num_workers),
+			FUZZ.corpus_size, __atomic_load_n(&FUZZ.edges, __ATOMIC_RELAXED), FUZZ.crashes, FUZZ.timeouts);
+		pthread_mutex_unlock(&FUZZ.lock);
+	}
+
+	__atomic_store_n(&FUZZ.stop, TRUE, __ATOMIC_RELAXED);
+	for (i = 0; i < num_workers; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+	printf("\nFuzzing finished: %u unique crash/timeout sites saved under %s/\n", FUZZ.num_artifacts, FUZZ_OUT_DIR);
+	printf("Throughput: %llu execs/s per worker (target %d: %s)\n\n", (unsigned long long)(execs / seconds / num_workers),
+		FUZZ_TARGET_EXECS, execs / seconds / num_workers >= FUZZ_TARGET_EXECS ? "met" : "missed");
+	free(FUZZ.corpus);
+	pthread_mutex_destroy(&FUZZ.lock);
+}
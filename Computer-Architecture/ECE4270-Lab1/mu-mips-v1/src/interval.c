@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "mu-mips.h"
+
+interval_state_t INTERVALS;
+
+/***************************************************************/
+/* Interval worker: claims intervals, re-simulates each on the timing model from  */
+/* its checkpoint and checks the result against the next checkpoint                         */
+/***************************************************************/
+void *interval_worker(void *arg){
+	interval_worker_t *worker = arg;
+	interval_result_t *result;
+	const checkpoint_t *ck;
+	struct timespec start, stop;
+	uint64_t *sum, *part;
+	uint32_t i, n;
+
+	TRACE_FLAG = FALSE;
+	QUIET_FLAG = TRUE;
+	init_memory();
+
+	while ((i = __atomic_fetch_add(&INTERVALS.next, 1, __ATOMIC_RELAXED)) < INTERVALS.num_checkpoints - 1) {
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+		ck = &INTERVALS.checkpoints[i];
+		checkpoint_restore(ck);
+		ooo_reset(); /* each interval starts with an empty pipeline and cold predictor */
+		memset(&MMU_STATS, 0, sizeof(MMU_STATS));
+		for (n = INTERVALS.checkpoints[i + 1].instruction_count - ck->instruction_count; RUN_FLAG && n > 0; n--) {
+			cycle();
+		}
+
+		result = &INTERVALS.results[i];
+		result->verified = checkpoint_matches(&INTERVALS.checkpoints[i + 1]);
+		result->instructions = OOO_MODEL->instructions;
+		result->cycles = OOO_MODEL->commit_cycle;
+		ooo_merge(worker->total, OOO_MODEL);
+		/* mmu_stats_t is all uint64_t counters */
+		sum = (uint64_t *)&worker->mmu;
+		part = (uint64_t *)&MMU_STATS;
+		for (n = 0; n < sizeof(mmu_stats_t) / sizeof(uint64_t); n++) {
+			sum[n] += part[n];
+		}
+		worker->intervals++;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+		result->elapsed_ns = (uint64_t)(stop.tv_sec - start.tv_sec) * 1000000000ULL + stop.tv_nsec - start.tv_nsec;
+	}
+
+	free(OOO_MODEL);
+	OOO_MODEL = NULL;
+	free_memory();
+	return NULL;
+}
+
+/***************************************************************/
+/* Run to completion with a fast functional pass that checkpoints every <length>  */
+/* instructions, then re-simulate the intervals on <num_workers> threads              */
+/***************************************************************/
+void interval_run(uint32_t length, int num_workers){
+	interval_worker_t workers[INTERVAL_MAX_WORKERS];
+	ooo_model_t *saved_model, *total;
+	journal_t *saved_journal;
+	struct timespec start, mid, stop;
+	uint64_t pages = 0, serial_ns = 0, tlb_misses = 0;
+	uint32_t capacity = 0, intervals, verified = 0, i, pc, elided;
+	int stopped = FALSE;
+	double pass_s, detail_s;
+
+	if (length < 1 || num_workers < 1 || num_workers > INTERVAL_MAX_WORKERS) {
+		printf("Usage: interval <instructions> <workers (1-%d)>\n\n", INTERVAL_MAX_WORKERS);
+		return;
+	}
+	if (RUN_FLAG == FALSE) {
+		printf("Simulation Stopped.\n\n");
+		return;
+	}
+
+	/* the functional pass runs with no timing model and no undo history */
+	saved_model = OOO_MODEL;
+	saved_journal = JOURNAL;
+	OOO_MODEL = NULL;
+	JOURNAL = NULL;
+	memset(&INTERVALS, 0, sizeof(INTERVALS));
+
+	printf("Functional pass, checkpoint every %u instructions...\n", length);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (;;) {
+		if (INTERVALS.num_checkpoints == INTERVAL_MAX_CHECKPOINTS || pages * MEM_PAGE_SIZE > INTERVAL_MAX_BYTES) {
+			/* keep every other checkpoint (always the first) and make intervals twice as long */
+			for (i = 0, pages = 0; i < INTERVALS.num_checkpoints; i++) {
+				if (i % 2 == 0) {
+					INTERVALS.checkpoints[i / 2] = INTERVALS.checkpoints[i];
+					pages += INTERVALS.checkpoints[i].memory.count;
+				}
+				else {
+					mem_snapshot_free(&INTERVALS.checkpoints[i].memory);
+				}
+			}
+			INTERVALS.num_checkpoints = (INTERVALS.num_checkpoints + 1) / 2;
+			length *= 2;
+		}
+		if (INTERVALS.num_checkpoints == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			INTERVALS.checkpoints = realloc(INTERVALS.checkpoints, capacity * sizeof(checkpoint_t));
+			assert(INTERVALS.checkpoints != NULL);
+		}
+		checkpoint_take(&INTERVALS.checkpoints[INTERVALS.num_checkpoints]);
+		pages += INTERVALS.checkpoints[INTERVALS.num_checkpoints++].memory.count;
+		if (!RUN_FLAG || stopped) break;
+		/* the next boundary is the next multiple of <length>, so thinning keeps intervals equal */
+		for (i = length - (INSTRUCTION_COUNT - INTERVALS.checkpoints[0].instruction_count) % length; RUN_FLAG && i > 0; i--) {
+			pc = CURRENT_STATE.PC;
+			cycle();
+			/* like runAll, stop at a loop that can never exit rather than checkpoint it forever */
+			if (!fast_forward(pc, i - 1, &elided)) {
+				printf("Loop at 0x%08x can never exit; stopping.\n", CURRENT_STATE.PC);
+				stopped = TRUE;
+				break;
+			}
+			i -= elided;
+			if (NUM_BREAKPOINTS > 0 && is_breakpoint(CURRENT_STATE.PC)) {
+				printf("Breakpoint at 0x%08x\n", CURRENT_STATE.PC);
+				stopped = TRUE;
+				break;
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &mid);
+	OOO_MODEL = saved_model;
+	JOURNAL = saved_journal;
+	if (JOURNAL != NULL) {
+		journal_clear();
+	}
+
+	intervals = INTERVALS.num_checkpoints - 1;
+	if (num_workers > (int)intervals) {
+		num_workers = intervals ? intervals : 1;
+	}
+	INTERVALS.results = calloc(intervals + 1, sizeof(interval_result_t));
+	assert(INTERVALS.results != NULL);
+	printf("Re-simulating %u intervals on %d workers...\n\n", intervals, num_workers);
+	for (i = 0; i < (uint32_t)num_workers; i++) {
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].total = calloc(1, sizeof(ooo_model_t));
+		assert(workers[i].total != NULL);
+		pthread_create(&workers[i].thread, NULL, interval_worker, &workers[i]);
+	}
+	total = calloc(1, sizeof(ooo_model_t));
+	assert(total != NULL);
+	for (i = 0; i < (uint32_t)num_workers; i++) {
+		pthread_join(workers[i].thread, NULL);
+		ooo_merge(total, workers[i].total);
+		tlb_misses += workers[i].mmu.tlb_misses;
+		free(workers[i].total);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	for (i = 0; i < intervals; i++) {
+		verified += INTERVALS.results[i].verified;
+		serial_ns += INTERVALS.results[i].elapsed_ns;
+	}
+	pass_s = (mid.tv_sec - start.tv_sec) + (mid.tv_nsec - start.tv_nsec) / 1e9;
+	detail_s = (stop.tv_sec - mid.tv_sec) + (stop.tv_nsec - mid.tv_nsec) / 1e9;
+
+	printf("-------------------------------------------------------------\n");
+	printf("Interval simulation: %u intervals of %u instructions\n", intervals, length);
+	printf("-------------------------------------------------------------\n");
+	printf("functional pass\t: %.3f s, %u checkpoints, %.1f MB of memory pages\n", pass_s, INTERVALS.num_checkpoints, pages * MEM_PAGE_SIZE / (1024.0 * 1024.0));
+	/* interval CPU time over workers x wall time: how busy the workers were, not a speedup over a serial run */
+	printf("detailed pass\t: %.3f s on %d workers (%.3f s of interval CPU time, %.0f%% parallel efficiency)\n", detail_s, num_workers, serial_ns / 1e9,
+		detail_s > 0 ? 100.0 * serial_ns / 1e9 / (detail_s * num_workers) : 0.0);
+	printf("verified\t: %u/%u intervals reached the next checkpoint's state\n", verified, intervals);
+	if (MMU_MODE != MMU_OFF) {
+		printf("TLB misses\t: %llu\n", (unsigned long long)tlb_misses);
+	}
+	if (intervals <= 64) {
+		printf("-------------------------------------------------------------\n");
+		printf("[Interval]\t[Start]\t\t[Instructions]\t[IPC]\t[Verified]\n");
+		for (i = 0; i < intervals; i++) {
+			printf("%u\t\t%llu\t\t%llu\t\t%.3f\t%s\n", i, (unsigned long long)INTERVALS.checkpoints[i].instruction_count, (unsigned long long)INTERVALS.results[i].instructions,
+				INTERVALS.results[i].cycles ? (double)INTERVALS.results[i].instructions / INTERVALS.results[i].cycles : 0.0, INTERVALS.results[i].verified ? "yes" : "NO");
+		}
+	}
+	else {
+		for (i = 0; i < intervals; i++) {
+			if (!INTERVALS.results[i].verified) {
+				printf("interval %u (from instruction %llu) did not match\n", i, (unsigned long long)INTERVALS.checkpoints[i].instruction_count);
+			}
+		}
+	}
+	printf("-------------------------------------------------------------\n\n");
+	ooo_report(total);
+
+	free(total);
+	for (i = 0; i < INTERVALS.num_checkpoints; i++) {
+		mem_snapshot_free(&INTERVALS.checkpoints[i].memory);
+	}
+	free(INTERVALS.checkpoints);
+	free(INTERVALS.results);
+	memset(&INTERVALS, 0, sizeof(INTERVALS));
+}
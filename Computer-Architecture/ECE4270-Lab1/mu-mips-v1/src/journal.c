@@ -0,0 +1,480 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <strings.h>
+#include <fenv.h>
+
+#include "mu-mips.h"
+
+__thread journal_t *JOURNAL;
+uint32_t BREAKPOINTS[MAX_BREAKPOINTS];
+int NUM_BREAKPOINTS;
+
+/************************************************************/
+/* Allocate the undo journal with <budget> bytes and checkpoint the current state */
+/************************************************************/
+void journal_init(uint64_t budget){
+	if(JOURNAL == NULL){
+		JOURNAL = calloc(1, sizeof(journal_t));
+		assert(JOURNAL != NULL);
+	}
+	journal_clear();
+	free(JOURNAL->records);
+	JOURNAL->budget = budget;
+	/* half for records (a power of two, so the ring wraps with a mask), half for checkpoints */
+	JOURNAL->capacity = 1;
+	while((uint64_t)JOURNAL->capacity * 2 * sizeof(journal_record_t) <= budget / 2){
+		JOURNAL->capacity *= 2;
+	}
+	JOURNAL->records = malloc((size_t)JOURNAL->capacity * sizeof(journal_record_t));
+	assert(JOURNAL->records != NULL);
+	journal_clear();
+}
+
+/************************************************************/
+/* Drop the journal; forward steps stop paying for it                                               */
+/************************************************************/
+void journal_free(){
+	if(JOURNAL == NULL){
+		return;
+	}
+	while(JOURNAL->num_checkpoints > 0){
+		journal_drop_checkpoint();
+	}
+	free(JOURNAL->records);
+	free(JOURNAL);
+	JOURNAL = NULL;
+}
+
+/************************************************************/
+/* journal on|off|<MB>: history is only recorded once asked for, since every          */
+/* journaled step costs a decode and ring pushes                                                   */
+/************************************************************/
+void journal_command(){
+	char arg[20];
+	uint32_t mb;
+
+	if(scanf("%19s", arg) != 1){
+		return;
+	}
+	if(strcasecmp(arg, "off") == 0){
+		journal_free();
+		printf("Reverse execution off.\n\n");
+		return;
+	}
+	if(strcasecmp(arg, "on") == 0){
+		mb = JOURNAL_DEFAULT_BYTES >> 20;
+	}
+	else if(sscanf(arg, "%u", &mb) != 1){
+		printf("Usage: journal on|off|<MB>\n\n");
+		return;
+	}
+	if(mb < JOURNAL_MIN_BYTES >> 20){
+		printf("Journal needs at least %d MB.\n\n", JOURNAL_MIN_BYTES >> 20);
+		return;
+	}
+	journal_init((uint64_t)mb << 20);
+	printf("Reverse execution on: %u MB journal, history starts here.\n\n", mb);
+}
+
+/************************************************************/
+/* Forget all history; the current state becomes the oldest reachable point           */
+/************************************************************/
+void journal_clear(){
+	uint32_t i;
+
+	JOURNAL->head = JOURNAL->count = JOURNAL->steps = 0;
+	for(i = 0; i < JOURNAL->num_checkpoints; i++){
+		mem_snapshot_free(&JOURNAL->checkpoints[i].memory);
+	}
+	JOURNAL->num_checkpoints = 0;
+	JOURNAL->checkpoint_bytes = 0;
+	JOURNAL->checkpoint_interval = JOURNAL_CHECKPOINT_INTERVAL;
+	if(JOURNAL->records != NULL){
+		journal_checkpoint();
+	}
+}
+
+/************************************************************/
+/* Push one record, dropping the oldest whole step if the ring is full                 */
+/************************************************************/
+void journal_push(uint8_t *loc, uint64_t old){
+	journal_t *j = JOURNAL;
+	uint64_t dropped;
+	uint32_t tail;
+
+	if(j->count == j->capacity){
+		tail = (j->head - j->count) & (j->capacity - 1);
+		dropped = 1;
+		do {
+			tail = (tail + 1) & (j->capacity - 1);
+			j->count--;
+			if(j->count > 0 && j->records[tail].loc == JOURNAL_SKIP){
+				dropped += j->records[tail].old;
+			}
+		} while(j->count > 0 && j->records[tail].loc != NULL);
+		j->steps -= dropped;
+	}
+	j->records[j->head].loc = loc;
+	j->records[j->head].old = old;
+	j->head = (j->head + 1) & (j->capacity - 1);
+	j->count++;
+}
+
+/************************************************************/
+/* Save the word at host address <loc> before it is overwritten                          */
+/************************************************************/
+void journal_record(uint8_t *loc){
+	uint32_t old;
+	memcpy(&old, loc, sizeof(old));
+	journal_push(loc, old);
+}
+
+/************************************************************/
+/* Start a step: mark it and save the registers the instruction is about to write */
+/* (memory is saved by mem_write_32; decoding up front is cheaper than diffing     */
+/* NEXT_STATE against CURRENT_STATE afterwards)                                                 */
+/************************************************************/
+void journal_begin_step(){
+	ooo_inst_t inst;
+	uint32_t *reg, instruction, i;
+
+	journal_push(NULL, CURRENT_STATE.PC);
+	JOURNAL->steps++;
+	instruction = vmem_peek_32(CURRENT_STATE.PC);
+	ooo_decode(instruction, &inst);
+	for(i = 0; i < inst.num_dests; i++){
+		if(inst.dests[i] == 0 || inst.dests[i] == OOO_REG_FCC) continue;
+		if(inst.dests[i] >= OOO_REG_FPR(0)){
+			reg = &FPR[inst.dests[i] - OOO_REG_FPR(0)];
+		}
+		else{
+			reg = inst.dests[i] == OOO_REG_HI ? &CURRENT_STATE.HI : (inst.dests[i] == OOO_REG_LO ? &CURRENT_STATE.LO : &CURRENT_STATE.REGS[inst.dests[i]]);
+		}
+		journal_push((uint8_t *)reg, *reg);
+	}
+	/* any COP1 instruction can change FCSR; fold pending flags so the old value is exact */
+	if((instruction & 0xFC000000) >> 26 == 0x11){
+		fpu_sync();
+		journal_push((uint8_t *)&FCSR, FCSR);
+	}
+}
+
+/************************************************************/
+/* Undo the newest journaled instruction (or fast-forwarded loop); FALSE if none      */
+/************************************************************/
+int journal_undo_step(){
+	journal_t *j = JOURNAL;
+	journal_record_t *r;
+	uint64_t extra = 0;
+	uint32_t word;
+
+	if(j->steps == 0){
+		return FALSE;
+	}
+	fpu_sync(); /* so restoring a journaled FCSR drops exactly the undone step's flags */
+	do {
+		j->head = (j->head - 1) & (j->capacity - 1);
+		j->count--;
+		r = &j->records[j->head];
+		if(r->loc == JOURNAL_SKIP){
+			extra += r->old;
+		}
+		else if(r->loc != NULL){
+			word = (uint32_t)r->old;
+			memcpy(r->loc, &word, sizeof(word));
+		}
+	} while(r->loc != NULL);
+	j->steps -= 1 + extra;
+	utlb_flush(); /* the step may have rewritten CP0 or the TLB */
+
+	CURRENT_STATE.PC = (uint32_t)r->old;
+	NEXT_STATE = CURRENT_STATE;
+	INSTRUCTION_COUNT -= 1 + extra;
+	RUN_FLAG = TRUE;
+	timer_schedule();
+	if(j->num_checkpoints > 1 && j->checkpoints[j->num_checkpoints - 1].instruction_count > INSTRUCTION_COUNT){
+		/* the newest checkpoint is now in the future; it will be retaken on the way forward */
+		j->next_checkpoint = j->checkpoints[j->num_checkpoints - 1].instruction_count;
+		journal_drop_checkpoint();
+		event_schedule();
+	}
+	return TRUE;
+}
+
+void journal_drop_checkpoint(){
+	checkpoint_t *ck = &JOURNAL->checkpoints[--JOURNAL->num_checkpoints];
+	JOURNAL->checkpoint_bytes -= (uint64_t)ck->memory.count * MEM_PAGE_SIZE;
+	mem_snapshot_free(&ck->memory);
+}
+
+/************************************************************/
+/* Checkpoint the architectural state; thin out old checkpoints when over budget    */
+/************************************************************/
+void journal_checkpoint(){
+	journal_t *j = JOURNAL;
+	checkpoint_t *ck;
+	uint32_t i, kept;
+
+	if(j->num_checkpoints == JOURNAL_MAX_CHECKPOINTS || j->checkpoint_bytes > j->budget / 2){
+		/* keep every other checkpoint (always the first) and space new ones twice as far apart */
+		j->checkpoint_bytes = 0;
+		for(i = 0, kept = 0; i < j->num_checkpoints; i++){
+			if(i % 2 == 0){
+				j->checkpoints[kept++] = j->checkpoints[i];
+				j->checkpoint_bytes += (uint64_t)j->checkpoints[i].memory.count * MEM_PAGE_SIZE;
+			}
+			else{
+				mem_snapshot_free(&j->checkpoints[i].memory);
+			}
+		}
+		j->num_checkpoints = kept;
+		j->checkpoint_interval *= 2;
+	}
+
+	ck = &j->checkpoints[j->num_checkpoints++];
+	checkpoint_take(ck);
+	j->checkpoint_bytes += (uint64_t)ck->memory.count * MEM_PAGE_SIZE;
+	j->next_checkpoint = INSTRUCTION_COUNT + j->checkpoint_interval;
+	event_schedule();
+}
+
+/************************************************************/
+/* Capture the whole architectural state (registers, CP0/TLB, FPU, memory)      */
+/************************************************************/
+void checkpoint_take(checkpoint_t *ck){
+	ck->state = CURRENT_STATE;
+	ck->instruction_count = INSTRUCTION_COUNT;
+	ck->run_flag = RUN_FLAG;
+	memcpy(ck->cp0, CP0, sizeof(CP0));
+	memcpy(ck->tlb, TLB, sizeof(TLB));
+	ck->random_base = RANDOM_BASE;
+	ck->count_bias = COUNT_BIAS;
+	fpu_sync();
+	memcpy(ck->fpr, FPR, sizeof(FPR));
+	ck->fcsr = FCSR;
+	mem_snapshot_take(&ck->memory);
+}
+
+/************************************************************/
+/* Make <ck> the current machine state                                                              */
+/************************************************************/
+void checkpoint_restore(const checkpoint_t *ck){
+	CURRENT_STATE = ck->state;
+	NEXT_STATE = CURRENT_STATE;
+	INSTRUCTION_COUNT = ck->instruction_count;
+	RUN_FLAG = ck->run_flag;
+	memcpy(CP0, ck->cp0, sizeof(CP0));
+	memcpy(TLB, ck->tlb, sizeof(TLB));
+	RANDOM_BASE = ck->random_base;
+	COUNT_BIAS = ck->count_bias;
+	timer_schedule();
+	memcpy(FPR, ck->fpr, sizeof(FPR));
+	FCSR = ck->fcsr;
+	feclearexcept(FE_ALL_EXCEPT);
+	mem_snapshot_restore(&ck->memory); /* also flushes the micro-TLB */
+}
+
+/************************************************************/
+/* TRUE if the current machine state is exactly <ck>                                             */
+/************************************************************/
+int checkpoint_matches(const checkpoint_t *ck){
+	fpu_sync();
+	return memcmp(&CURRENT_STATE, &ck->state, sizeof(CPU_State)) == 0 &&
+		INSTRUCTION_COUNT == ck->instruction_count &&
+		RUN_FLAG == ck->run_flag &&
+		memcmp(CP0, ck->cp0, sizeof(CP0)) == 0 && COUNT_BIAS == ck->count_bias &&
+		memcmp(TLB, ck->tlb, sizeof(TLB)) == 0 &&
+		memcmp(FPR, ck->fpr, sizeof(FPR)) == 0 && FCSR == ck->fcsr &&
+		mem_snapshot_matches(&ck->memory);
+}
+
+/************************************************************/
+/* Return to checkpoint <index>, discarding the journal and later checkpoints       */
+/************************************************************/
+void journal_restore(uint32_t index){
+	journal_t *j = JOURNAL;
+
+	checkpoint_restore(&j->checkpoints[index]);
+	while(j->num_checkpoints > index + 1){
+		journal_drop_checkpoint();
+	}
+	j->head = j->count = j->steps = 0;
+	j->next_checkpoint = INSTRUCTION_COUNT + j->checkpoint_interval;
+	event_schedule();
+}
+
+/************************************************************/
+/* Execute one instruction of a replay towards instruction <target>, skipping loops  */
+/* as run() did. A replay never stops at breakpoints, so they don't keep a loop     */
+/* from being skipped; returns the instructions skipped                                        */
+/************************************************************/
+uint32_t journal_replay_step(uint64_t target){
+	uint32_t pc = CURRENT_STATE.PC, elided;
+	int num_breakpoints = NUM_BREAKPOINTS;
+
+	cycle();
+	NUM_BREAKPOINTS = 0;
+	fast_forward(pc, target - INSTRUCTION_COUNT < FF_UNLIMITED ? target - INSTRUCTION_COUNT : FF_UNLIMITED - 1, &elided);
+	NUM_BREAKPOINTS = num_breakpoints;
+	return elided;
+}
+
+/************************************************************/
+/* Move back to instruction count <target>: undo within the journal, otherwise   */
+/* restore the nearest earlier checkpoint and re-execute forward                          */
+/************************************************************/
+void journal_seek(uint64_t target){
+	journal_t *j = JOURNAL;
+	int i, trace;
+
+	if(target >= INSTRUCTION_COUNT){
+		return;
+	}
+	if(INSTRUCTION_COUNT - target <= j->steps){
+		/* undoing a fast-forwarded loop can overshoot; replay the rest */
+		while(INSTRUCTION_COUNT > target){
+			journal_undo_step();
+		}
+	}
+	else{
+		for(i = j->num_checkpoints - 1; i > 0 && j->checkpoints[i].instruction_count > target; i--);
+		journal_restore(i);
+	}
+	/* replay the way run() got here, so loops skipped on the way forward are skipped again */
+	trace = TRACE_FLAG;
+	TRACE_FLAG = FALSE;
+	while(INSTRUCTION_COUNT < target && RUN_FLAG){
+		journal_replay_step(target);
+	}
+	fpu_sync();
+	TRACE_FLAG = trace;
+}
+
+/************************************************************/
+/* Print where a reverse command stopped                                                          */
+/************************************************************/
+void reverse_report(){
+	printf("Now at instruction %llu, PC 0x%08x: ", (unsigned long long)INSTRUCTION_COUNT, CURRENT_STATE.PC);
+	print_instruction(CURRENT_STATE.PC);
+	printf("\n");
+}
+
+/************************************************************/
+/* Step backwards <n> instructions                                                                        */
+/************************************************************/
+void rstep(uint32_t n){
+	uint64_t target = n > INSTRUCTION_COUNT ? 0 : INSTRUCTION_COUNT - n;
+
+	if(JOURNAL == NULL){
+		printf("Reverse execution is off; use journal on first.\n\n");
+		return;
+	}
+	journal_seek(target);
+	if(INSTRUCTION_COUNT != target){
+		printf("History before instruction %llu is not available.\n", (unsigned long long)INSTRUCTION_COUNT);
+	}
+	reverse_report();
+}
+
+/************************************************************/
+/* Run backwards to the previous breakpoint or the oldest reachable state           */
+/************************************************************/
+void rcontinue(){
+	journal_t *j = JOURNAL;
+	uint64_t end, found;
+	uint32_t pc, head, body;
+	int i, b, trace, hit;
+
+	if(j == NULL){
+		printf("Reverse execution is off; use journal on first.\n\n");
+		return;
+	}
+	if(INSTRUCTION_COUNT == 0 || (j->steps == 0 && j->checkpoints[0].instruction_count == INSTRUCTION_COUNT)){
+		printf("Already at the oldest reachable state.\n");
+		reverse_report();
+		return;
+	}
+
+	while(journal_undo_step()){
+		if(is_breakpoint(CURRENT_STATE.PC)){
+			printf("Breakpoint at 0x%08x\n", CURRENT_STATE.PC);
+			reverse_report();
+			return;
+		}
+	}
+
+	/* older history: replay each checkpoint interval, newest first, looking for the last hit */
+	end = INSTRUCTION_COUNT;
+	trace = TRACE_FLAG;
+	TRACE_FLAG = FALSE;
+	for(i = j->num_checkpoints - 1; i >= 0 && NUM_BREAKPOINTS > 0; i--){
+		if(j->checkpoints[i].instruction_count >= end) continue;
+		journal_restore(i);
+		hit = FALSE;
+		found = 0;
+		while(INSTRUCTION_COUNT < end && RUN_FLAG){
+			if(is_breakpoint(CURRENT_STATE.PC)){
+				hit = TRUE;
+				found = INSTRUCTION_COUNT;
+			}
+			pc = CURRENT_STATE.PC;
+			if(journal_replay_step(end) == 0){
+				continue;
+			}
+			/* a skipped loop passed its breakpoints last in its last skipped iteration */
+			head = CURRENT_STATE.PC;
+			body = (pc - head) / 4 + 1;
+			for(b = 0; b < NUM_BREAKPOINTS; b++){
+				if(BREAKPOINTS[b] >= head && BREAKPOINTS[b] <= pc && INSTRUCTION_COUNT - body + (BREAKPOINTS[b] - head) / 4 >= found){
+					hit = TRUE;
+					found = INSTRUCTION_COUNT - body + (BREAKPOINTS[b] - head) / 4;
+				}
+			}
+		}
+		if(hit){
+			journal_seek(found);
+			TRACE_FLAG = trace;
+			printf("Breakpoint at 0x%08x\n", CURRENT_STATE.PC);
+			reverse_report();
+			return;
+		}
+		end = j->checkpoints[i].instruction_count;
+	}
+	if(INSTRUCTION_COUNT > j->checkpoints[0].instruction_count){
+		journal_restore(0);
+	}
+	TRACE_FLAG = trace;
+	printf("Reached the oldest reachable state.\n");
+	reverse_report();
+}
+
+int is_breakpoint(uint32_t addr){
+	int i;
+	for(i = 0; i < NUM_BREAKPOINTS; i++){
+		if(BREAKPOINTS[i] == addr) return TRUE;
+	}
+	return FALSE;
+}
+
+/************************************************************/
+/* Set a breakpoint at <addr>, or clear it if already set                                      */
+/************************************************************/
+void toggle_breakpoint(uint32_t addr){
+	int i;
+	for(i = 0; i < NUM_BREAKPOINTS; i++){
+		if(BREAKPOINTS[i] == addr){
+			BREAKPOINTS[i] = BREAKPOINTS[--NUM_BREAKPOINTS];
+			printf("Breakpoint at 0x%08x cleared.\n\n", addr);
+			return;
+		}
+	}
+	if(NUM_BREAKPOINTS == MAX_BREAKPOINTS){
+		printf("Error: at most %d breakpoints.\n\n", MAX_BREAKPOINTS);
+		return;
+	}
+	BREAKPOINTS[NUM_BREAKPOINTS++] = addr;
+	printf("Breakpoint at 0x%08x set.\n\n", addr);
+}
@@ -0,0 +1,584 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+
+#include "mu-mips.h"
+
+__thread uint32_t CP0[CP0_REGS];
+__thread tlb_entry_t TLB[TLB_ENTRIES];
+__thread uint32_t RANDOM_BASE;
+__thread uint32_t COUNT_BIAS;
+__thread uint64_t NEXT_EVENT;
+__thread uint64_t TIMER_EVENT;
+__thread uint64_t TIMER_MATCH;
+__thread int EXCEPTION_PENDING;
+__thread uint32_t EXCEPTION_VECTOR;
+int MMU_MODE;
+__thread mmu_stats_t MMU_STATS;
+__thread utlb_entry_t UTLB_READ[UTLB_SIZE], UTLB_WRITE[UTLB_SIZE];
+__thread uint64_t UTLB_GEN = 1ULL << 32;
+
+/***************************************************************/
+/* Invalidate every micro-TLB entry (O(1): bump the generation)           */
+/***************************************************************/
+void utlb_flush()
+{
+	UTLB_GEN += 1ULL << 32;
+	if (UTLB_GEN == 0) {
+		memset(UTLB_READ, 0, sizeof(UTLB_READ));
+		memset(UTLB_WRITE, 0, sizeof(UTLB_WRITE));
+		UTLB_GEN = 1ULL << 32;
+	}
+}
+
+/***************************************************************/
+/* Micro-TLB miss on a read: translate, refill the entry, read                */
+/***************************************************************/
+uint32_t vmem_read_slow(uint32_t address)
+{
+	uint32_t physical;
+	uint8_t *host;
+
+	MMU_STATS.utlb_misses++;
+	if (!tlb_translate(address, FALSE, &physical)) {
+		return 0;
+	}
+	host = mem_host_page(physical);
+	if (host != NULL) {
+		UTLB_READ[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)].tag = UTLB_GEN | (address & ~(MEM_PAGE_SIZE - 1));
+		UTLB_READ[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)].host = host;
+	}
+	/* a word straddling two pages is read as physically contiguous */
+	return mem_read_32(physical);
+}
+
+/***************************************************************/
+/* Micro-TLB miss on a write: translate, write (marking the page dirty),  */
+/* then cache the page for writing                                                                */
+/***************************************************************/
+void vmem_write_slow(uint32_t address, uint32_t value)
+{
+	uint32_t physical;
+	uint8_t *host;
+
+	MMU_STATS.utlb_misses++;
+	if (!tlb_translate(address, TRUE, &physical)) {
+		return;
+	}
+	mem_write_32(physical, value);
+	host = mem_host_page(physical);
+	if (host != NULL) {
+		/* safe to cache: the page is dirty now, and clear_memory() flushes the micro-TLB */
+		UTLB_WRITE[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)].tag = UTLB_GEN | (address & ~(MEM_PAGE_SIZE - 1));
+		UTLB_WRITE[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)].host = host;
+	}
+}
+
+/***************************************************************/
+/* Read a word at a virtual address with no exceptions or statistics        */
+/***************************************************************/
+uint32_t vmem_peek_32(uint32_t address)
+{
+	utlb_entry_t *e = &UTLB_READ[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)];
+	uint32_t physical = address, mask, lo;
+	uint8_t *p;
+	int i;
+
+	if (e->tag == (UTLB_GEN | (address & ~(MEM_PAGE_SIZE - 1))) && (address & (MEM_PAGE_SIZE - 1)) <= MEM_PAGE_SIZE - 4) {
+		p = e->host + (address & (MEM_PAGE_SIZE - 1));
+		return (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+	}
+	if (MMU_MODE != MMU_OFF && (address < 0x80000000 || address >= 0xC0000000)) {
+		for (i = 0; i < TLB_ENTRIES; i++) {
+			mask = TLB[i].pagemask | 0x1FFF;
+			if (((TLB[i].entryhi ^ address) & ~mask) == 0 &&
+				((TLB[i].entrylo0 & TLB[i].entrylo1 & ENTRYLO_G) || (TLB[i].entryhi & ENTRYHI_ASID) == (CP0[CP0_ENTRYHI] & ENTRYHI_ASID))) {
+				lo = (address & ((mask >> 1) + 1)) ? TLB[i].entrylo1 : TLB[i].entrylo0;
+				if (!(lo & ENTRYLO_V)) return 0;
+				physical = ((((lo & ENTRYLO_PFN) >> 6) << MEM_PAGE_SHIFT) & ~(mask >> 1)) | (address & (mask >> 1));
+				break;
+			}
+		}
+		if (i == TLB_ENTRIES) return 0;
+	}
+	if (mem_host_page(physical) == NULL) {
+		return 0;
+	}
+	return mem_read_32(physical);
+}
+
+/***************************************************************/
+/* Translate <address> for a load or store; raises the exception and       */
+/* returns FALSE when the access can't proceed                                          */
+/***************************************************************/
+int tlb_translate(uint32_t address, int write, uint32_t *physical)
+{
+	uint32_t mask, lo, asid, vpn2;
+	int i;
+
+	if (MMU_MODE == MMU_OFF) {
+		*physical = address;
+		return TRUE;
+	}
+	if ((CP0[CP0_STATUS] & (STATUS_KSU | STATUS_EXL | STATUS_ERL)) == STATUS_KSU_USER && address >= 0x80000000) {
+		MMU_STATS.address_errors++;
+		raise_exception(write ? EXC_ADES : EXC_ADEL, address, FALSE);
+		return FALSE;
+	}
+	/* kseg0 and kseg1 are unmapped; the lab memory layout already places ktext/kdata there */
+	if (address >= 0x80000000 && address < 0xC0000000) {
+		*physical = address;
+		return TRUE;
+	}
+
+	MMU_STATS.tlb_lookups++;
+	asid = CP0[CP0_ENTRYHI] & ENTRYHI_ASID;
+	for (i = 0; i < TLB_ENTRIES; i++) {
+		mask = TLB[i].pagemask | 0x1FFF;
+		if (((TLB[i].entryhi ^ address) & ~mask) == 0 &&
+			((TLB[i].entrylo0 & TLB[i].entrylo1 & ENTRYLO_G) || (TLB[i].entryhi & ENTRYHI_ASID) == asid)) {
+			/* each entry maps an even/odd pair of pages */
+			lo = (address & ((mask >> 1) + 1)) ? TLB[i].entrylo1 : TLB[i].entrylo0;
+			if (!(lo & ENTRYLO_V)) {
+				MMU_STATS.invalid++;
+				raise_exception(write ? EXC_TLBS : EXC_TLBL, address, FALSE);
+				return FALSE;
+			}
+			if (write && !(lo & ENTRYLO_D)) {
+				MMU_STATS.modified++;
+				raise_exception(EXC_MOD, address, FALSE);
+				return FALSE;
+			}
+			*physical = ((((lo & ENTRYLO_PFN) >> 6) << MEM_PAGE_SHIFT) & ~(mask >> 1)) | (address & (mask >> 1));
+			return TRUE;
+		}
+	}
+
+	MMU_STATS.tlb_misses++;
+	if (MMU_MODE == MMU_SOFT) {
+		/* act as the refill handler: identity-map the even/odd pair at Random */
+		MMU_STATS.refills++;
+		vpn2 = address & ENTRYHI_VPN2;
+		i = cp0_read(CP0_RANDOM);
+		if (JOURNAL != NULL) {
+			journal_record((uint8_t *)&TLB[i].pagemask);
+			journal_record((uint8_t *)&TLB[i].entryhi);
+			journal_record((uint8_t *)&TLB[i].entrylo0);
+			journal_record((uint8_t *)&TLB[i].entrylo1);
+		}
+		TLB[i].pagemask = 0;
+		TLB[i].entryhi = vpn2;
+		TLB[i].entrylo0 = ((vpn2 >> MEM_PAGE_SHIFT) << 6) | ENTRYLO_C | ENTRYLO_D | ENTRYLO_V | ENTRYLO_G;
+		TLB[i].entrylo1 = (((vpn2 | MEM_PAGE_SIZE) >> MEM_PAGE_SHIFT) << 6) | ENTRYLO_C | ENTRYLO_D | ENTRYLO_V | ENTRYLO_G;
+		utlb_flush();
+		return tlb_translate(address, write, physical);
+	}
+	raise_exception(write ? EXC_TLBS : EXC_TLBL, address, TRUE);
+	return FALSE;
+}
+
+/***************************************************************/
+/* Power-on CP0 and TLB state (kernel mode, exceptions enabled off)       */
+/***************************************************************/
+void cp0_reset()
+{
+	int i;
+
+	memset(CP0, 0, sizeof(CP0));
+	CP0[CP0_PRID] = CP0_PRID_R4400;
+	CP0[CP0_STATUS] = STATUS_CU1; /* user programs may use the FPU without a kernel to enable it */
+	/* park every entry on a distinct kseg0 VPN2, which is never translated */
+	for (i = 0; i < TLB_ENTRIES; i++) {
+		TLB[i].pagemask = 0;
+		TLB[i].entryhi = EXC_VECTOR_REFILL + i * 2 * MEM_PAGE_SIZE;
+		TLB[i].entrylo0 = TLB[i].entrylo1 = 0;
+	}
+	RANDOM_BASE = INSTRUCTION_COUNT;
+	COUNT_BIAS = INSTRUCTION_COUNT >> 1;
+	EXCEPTION_PENDING = FALSE;
+	memset(&MMU_STATS, 0, sizeof(MMU_STATS));
+	utlb_flush();
+	timer_schedule();
+}
+
+/***************************************************************/
+/* MFC0: Random counts down from 47 to Wired, one step per instruction, */
+/* and Count up, one step every other cycle                                               */
+/***************************************************************/
+uint32_t cp0_read(int reg)
+{
+	uint32_t wired;
+
+	if (reg == CP0_COUNT) {
+		return (uint32_t)(INSTRUCTION_COUNT >> 1) - COUNT_BIAS;
+	}
+	if (reg == CP0_RANDOM) {
+		wired = CP0[CP0_WIRED] & 0x3F;
+		if (wired >= TLB_ENTRIES) {
+			return TLB_ENTRIES - 1;
+		}
+		return TLB_ENTRIES - 1 - ((uint32_t)INSTRUCTION_COUNT - RANDOM_BASE) % (TLB_ENTRIES - wired);
+	}
+	return CP0[reg];
+}
+
+/***************************************************************/
+/* Set a CP0 register as the hardware does (no write masks), journaled  */
+/***************************************************************/
+void cp0_set(int reg, uint32_t value)
+{
+	if (JOURNAL != NULL) {
+		journal_record((uint8_t *)&CP0[reg]);
+	}
+	CP0[reg] = value;
+}
+
+/***************************************************************/
+/* MTC0: only the architecturally writable fields change                          */
+/***************************************************************/
+void cp0_write(int reg, uint32_t value)
+{
+	switch (reg) {
+		case CP0_INDEX:
+			cp0_set(reg, (CP0[reg] & INDEX_P) | (value & 0x3F));
+			break;
+		case CP0_ENTRYLO0:
+		case CP0_ENTRYLO1:
+			cp0_set(reg, value & (ENTRYLO_PFN | ENTRYLO_C | ENTRYLO_D | ENTRYLO_V | ENTRYLO_G));
+			break;
+		case CP0_CONTEXT:
+			cp0_set(reg, (CP0[reg] & 0x007FFFF0) | (value & 0xFF800000));
+			break;
+		case CP0_PAGEMASK:
+			cp0_set(reg, value & PAGEMASK_MASK);
+			break;
+		case CP0_WIRED:
+			cp0_set(reg, value & 0x3F);
+			if (JOURNAL != NULL) {
+				journal_record((uint8_t *)&RANDOM_BASE);
+			}
+			RANDOM_BASE = INSTRUCTION_COUNT;
+			break;
+		case CP0_COUNT:
+			if (JOURNAL != NULL) {
+				journal_record((uint8_t *)&COUNT_BIAS);
+			}
+			COUNT_BIAS = (uint32_t)(INSTRUCTION_COUNT >> 1) - value;
+			timer_schedule();
+			break;
+		case CP0_COMPARE:
+			/* writing Compare acknowledges the timer interrupt */
+			cp0_set(reg, value);
+			cp0_set(CP0_CAUSE, CP0[CP0_CAUSE] & ~CAUSE_IP7);
+			timer_schedule();
+			break;
+		case CP0_ENTRYHI:
+			cp0_set(reg, value & (ENTRYHI_VPN2 | ENTRYHI_ASID));
+			utlb_flush();
+			break;
+		case CP0_STATUS:
+			cp0_set(reg, value);
+			utlb_flush();
+			timer_schedule();
+			break;
+		case CP0_CAUSE:
+			/* only the two software interrupt bits */
+			cp0_set(reg, (CP0[reg] & ~0x300) | (value & 0x300));
+			timer_schedule();
+			break;
+		case CP0_EPC:
+		case CP0_ERROREPC:
+		case CP0_CONFIG:
+			cp0_set(reg, value);
+			break;
+		default: /* Random, BadVAddr, PRId and unimplemented registers are read-only */
+			break;
+	}
+}
+
+/***************************************************************/
+/* Take exception <code>: the current instruction has no effect and the  */
+/* next PC is the vector (refill vector only for TLB misses outside EXL)   */
+/***************************************************************/
+void raise_exception(int code, uint32_t badvaddr, int refill)
+{
+	static const char *names[] = { "Int", "Mod", "TLBL", "TLBS", "AdEL", "AdES", "IBE", "DBE", "Sys", "Bp", "RI", "CpU", "Ov", "Tr", "VCEI", "FPE" };
+	uint32_t status = CP0[CP0_STATUS];
+
+	MMU_STATS.exceptions++;
+	EXCEPTION_PENDING = TRUE;
+	EXCEPTION_VECTOR = (refill && !(status & STATUS_EXL)) ? EXC_VECTOR_REFILL : EXC_VECTOR_GENERAL;
+
+	cp0_set(CP0_CAUSE, (CP0[CP0_CAUSE] & ~CAUSE_EXCCODE) | (code << 2));
+	if (!(status & STATUS_EXL)) {
+		cp0_set(CP0_EPC, CURRENT_STATE.PC);
+	}
+	if (code == EXC_MOD || code == EXC_TLBL || code == EXC_TLBS || code == EXC_ADEL || code == EXC_ADES) {
+		cp0_set(CP0_BADVADDR, badvaddr);
+		cp0_set(CP0_CONTEXT, (CP0[CP0_CONTEXT] & 0xFF800000) | ((badvaddr >> 13) << 4));
+		cp0_set(CP0_ENTRYHI, (badvaddr & ENTRYHI_VPN2) | (CP0[CP0_ENTRYHI] & ENTRYHI_ASID));
+	}
+	cp0_set(CP0_STATUS, status | STATUS_EXL);
+	utlb_flush();
+
+	/* nothing was ever stored at the vector, so there is no handler to run: stop */
+	if (!mem_page_written(EXCEPTION_VECTOR)) {
+		if (!QUIET_FLAG) {
+			printf("Unhandled %s exception at PC 0x%08x (BadVAddr 0x%08x)\n", code < 16 ? names[code] : "?", CURRENT_STATE.PC, badvaddr);
+		}
+		RUN_FLAG = FALSE;
+		FAULT_FLAG = FAULT_EXCEPTION;
+		FAULT_ADDR = badvaddr;
+	}
+}
+
+/***************************************************************/
+/* TRUE if an interrupt pending in Cause and unmasked in Status is taken    */
+/***************************************************************/
+int interrupts_enabled()
+{
+	return (CP0[CP0_STATUS] & (STATUS_IE | STATUS_EXL | STATUS_ERL)) == STATUS_IE;
+}
+
+/***************************************************************/
+/* Recompute TIMER_EVENT after Count, Compare, Status or Cause change.  */
+/* Count and Compare are checked at the end of each cycle, so the next   */
+/* match is the first Count tick after the current instruction count        */
+/***************************************************************/
+void timer_schedule()
+{
+	uint64_t tick = (INSTRUCTION_COUNT >> 1) + 1;
+
+	TIMER_MATCH = (tick + (uint32_t)(CP0[CP0_COMPARE] + COUNT_BIAS - (uint32_t)tick)) << 1;
+	if (interrupts_enabled() && (CP0[CP0_CAUSE] & CP0[CP0_STATUS] & CAUSE_IP)) {
+		TIMER_EVENT = INSTRUCTION_COUNT; /* deliver at the end of this cycle */
+	}
+	else {
+		TIMER_EVENT = TIMER_MATCH;
+	}
+	event_schedule();
+}
+
+/***************************************************************/
+/* End of a cycle at TIMER_EVENT: raise IP7 if Count reached Compare and  */
+/* take any deliverable interrupt before the next instruction                      */
+/***************************************************************/
+void timer_event()
+{
+	if (INSTRUCTION_COUNT >= TIMER_MATCH) {
+		cp0_set(CP0_CAUSE, CP0[CP0_CAUSE] | CAUSE_IP7);
+	}
+	if (interrupts_enabled() && (CP0[CP0_CAUSE] & CP0[CP0_STATUS] & CAUSE_IP)) {
+		/* EPC is the instruction that would have run next */
+		raise_exception(EXC_INT, 0, FALSE);
+		CURRENT_STATE.PC = EXCEPTION_VECTOR;
+		NEXT_STATE = CURRENT_STATE;
+		EXCEPTION_PENDING = FALSE;
+	}
+	timer_schedule();
+}
+
+/***************************************************************/
+/* NEXT_EVENT is the earliest of the timer, the next journal checkpoint   */
+/* and the next telemetry snapshot; call after changing any of them      */
+/***************************************************************/
+void event_schedule()
+{
+	NEXT_EVENT = TIMER_EVENT < TELEMETRY_NEXT ? TIMER_EVENT : TELEMETRY_NEXT;
+	if (JOURNAL != NULL && JOURNAL->next_checkpoint < NEXT_EVENT) {
+		NEXT_EVENT = JOURNAL->next_checkpoint;
+	}
+}
+
+/***************************************************************/
+/* The slow path of cycle() and fast_forward(), run once                           */
+/* INSTRUCTION_COUNT reaches NEXT_EVENT                                                 */
+/***************************************************************/
+void event_dispatch()
+{
+	if (INSTRUCTION_COUNT >= TIMER_EVENT) {
+		timer_event();
+	}
+	if (JOURNAL != NULL && INSTRUCTION_COUNT >= JOURNAL->next_checkpoint) {
+		journal_checkpoint();
+	}
+	if (INSTRUCTION_COUNT >= TELEMETRY_NEXT) {
+		telemetry_snapshot();
+	}
+	event_schedule();
+}
+
+/***************************************************************/
+/* A word of the counter page; the 64-bit counts are split low word first   */
+/***************************************************************/
+uint32_t counters_read(uint32_t address)
+{
+	switch (address & (MEM_PAGE_SIZE - 1)) {
+		case COUNTERS_INSTRET:
+			return (uint32_t)INSTRUCTION_COUNT;
+		case COUNTERS_INSTRET + 4:
+			return (uint32_t)(INSTRUCTION_COUNT >> 32);
+		case COUNTERS_CYCLE:
+			return (uint32_t)INSTRUCTION_COUNT;
+		case COUNTERS_CYCLE + 4:
+			return (uint32_t)(INSTRUCTION_COUNT >> 32);
+		case COUNTERS_COUNT:
+			return cp0_read(CP0_COUNT);
+		case COUNTERS_COMPARE:
+			return CP0[CP0_COMPARE];
+		default:
+			return 0;
+	}
+}
+
+/***************************************************************/
+/* TLBWI/TLBWR: copy PageMask, EntryHi and EntryLo0/1 into entry <index>  */
+/***************************************************************/
+void tlb_write(int index)
+{
+	if (index >= TLB_ENTRIES) {
+		return;
+	}
+	if (JOURNAL != NULL) {
+		journal_record((uint8_t *)&TLB[index].pagemask);
+		journal_record((uint8_t *)&TLB[index].entryhi);
+		journal_record((uint8_t *)&TLB[index].entrylo0);
+		journal_record((uint8_t *)&TLB[index].entrylo1);
+	}
+	TLB[index].pagemask = CP0[CP0_PAGEMASK];
+	TLB[index].entryhi = CP0[CP0_ENTRYHI] & ~CP0[CP0_PAGEMASK];
+	TLB[index].entrylo0 = CP0[CP0_ENTRYLO0];
+	TLB[index].entrylo1 = CP0[CP0_ENTRYLO1];
+	utlb_flush();
+}
+
+/***************************************************************/
+/* Execute a COP0 instruction; TRUE if it redirected the PC (ERET)          */
+/***************************************************************/
+int handle_cop0(uint32_t instruction)
+{
+	uint32_t rs, rt, rd, function, mask;
+	int i;
+
+	rs = (instruction & 0x03E00000) >> 21;
+	rt = (instruction & 0x001F0000) >> 16;
+	rd = (instruction & 0x0000F800) >> 11;
+	function = instruction & 0x0000003F;
+
+	if (rs == 0x00) { //MFC0
+		NEXT_STATE.REGS[rt] = cp0_read(rd);
+		return FALSE;
+	}
+	if (rs == 0x04) { //MTC0
+		cp0_write(rd, CURRENT_STATE.REGS[rt]);
+		return FALSE;
+	}
+	if (!(rs & 0x10)) {
+		FAULT_FLAG = FAULT_ILLEGAL;
+		FAULT_ADDR = CURRENT_STATE.PC;
+		return FALSE;
+	}
+	switch (function) {
+		case 0x01: //TLBR
+			i = CP0[CP0_INDEX] & 0x3F;
+			if (i < TLB_ENTRIES) {
+				cp0_set(CP0_PAGEMASK, TLB[i].pagemask);
+				cp0_set(CP0_ENTRYHI, TLB[i].entryhi);
+				cp0_set(CP0_ENTRYLO0, TLB[i].entrylo0);
+				cp0_set(CP0_ENTRYLO1, TLB[i].entrylo1);
+				utlb_flush();
+			}
+			break;
+		case 0x02: //TLBWI
+			tlb_write(CP0[CP0_INDEX] & 0x3F);
+			break;
+		case 0x06: //TLBWR
+			tlb_write(cp0_read(CP0_RANDOM));
+			break;
+		case 0x08: //TLBP
+			cp0_set(CP0_INDEX, INDEX_P);
+			for (i = 0; i < TLB_ENTRIES; i++) {
+				mask = TLB[i].pagemask | 0x1FFF;
+				if (((TLB[i].entryhi ^ CP0[CP0_ENTRYHI]) & ~mask) == 0 &&
+					((TLB[i].entrylo0 & TLB[i].entrylo1 & ENTRYLO_G) || ((TLB[i].entryhi ^ CP0[CP0_ENTRYHI]) & ENTRYHI_ASID) == 0)) {
+					cp0_set(CP0_INDEX, i);
+					break;
+				}
+			}
+			break;
+		case 0x18: //ERET
+			if (CP0[CP0_STATUS] & STATUS_ERL) {
+				NEXT_STATE.PC = CP0[CP0_ERROREPC];
+				cp0_set(CP0_STATUS, CP0[CP0_STATUS] & ~STATUS_ERL);
+			}
+			else {
+				NEXT_STATE.PC = CP0[CP0_EPC];
+				cp0_set(CP0_STATUS, CP0[CP0_STATUS] & ~STATUS_EXL);
+			}
+			utlb_flush();
+			timer_schedule(); /* an interrupt held off by EXL is taken after the ERET */
+			return TRUE;
+		default:
+			FAULT_FLAG = FAULT_ILLEGAL;
+			FAULT_ADDR = CURRENT_STATE.PC;
+			break;
+	}
+	return FALSE;
+}
+
+/***************************************************************/
+/* TLB pressure report                                                                                    */
+/***************************************************************/
+void mmu_report()
+{
+	static const char *modes[] = { "off", "on (simulator refills)", "guest (refill exceptions)" };
+	double k = INSTRUCTION_COUNT ? INSTRUCTION_COUNT / 1000.0 : 1.0;
+
+	printf("-------------------------------------------------------------\n");
+	printf("MMU %s, %llu instructions\n", modes[MMU_MODE], (unsigned long long)INSTRUCTION_COUNT);
+	printf("-------------------------------------------------------------\n");
+	printf("[Event]\t\t\t[Count]\t[Per 1k instructions]\n");
+	printf("micro-TLB misses\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.utlb_misses, MMU_STATS.utlb_misses / k);
+	printf("TLB lookups\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.tlb_lookups, MMU_STATS.tlb_lookups / k);
+	printf("TLB misses\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.tlb_misses, MMU_STATS.tlb_misses / k);
+	printf("soft refills\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.refills, MMU_STATS.refills / k);
+	printf("TLB invalid\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.invalid, MMU_STATS.invalid / k);
+	printf("TLB modified\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.modified, MMU_STATS.modified / k);
+	printf("address errors\t\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.address_errors, MMU_STATS.address_errors / k);
+	printf("exceptions taken\t%llu\t%.3f\n", (unsigned long long)MMU_STATS.exceptions, MMU_STATS.exceptions / k);
+	printf("-------------------------------------------------------------\n\n");
+}
+
+/***************************************************************/
+/* mmu off|on|guest|stats|tlb                                                                          */
+/***************************************************************/
+void mmu_command()
+{
+	char command[20];
+	int i;
+
+	if (scanf("%19s", command) != 1) {
+		return;
+	}
+	if (strcasecmp(command, "off") == 0 || strcasecmp(command, "on") == 0 || strcasecmp(command, "guest") == 0) {
+		MMU_MODE = strcasecmp(command, "off") == 0 ? MMU_OFF : (strcasecmp(command, "on") == 0 ? MMU_SOFT : MMU_GUEST);
+		memset(&MMU_STATS, 0, sizeof(MMU_STATS));
+		utlb_flush();
+		printf("MMU %s.\n\n", command);
+	}
+	else if (strcasecmp(command, "stats") == 0) {
+		mmu_report();
+	}
+	else if (strcasecmp(command, "tlb") == 0) {
+		printf("[Entry]\t[PageMask]\t[EntryHi]\t[EntryLo0]\t[EntryLo1]\n");
+		for (i = 0; i < TLB_ENTRIES; i++) {
+			printf("%d\t0x%08x\t0x%08x\t0x%08x\t0x%08x\n", i, TLB[i].pagemask, TLB[i].entryhi, TLB[i].entrylo0, TLB[i].entrylo1);
+		}
+		printf("\n");
+	}
+	else {
+		printf("Usage: mmu off|on|guest|stats|tlb\n\n");
+	}
+}
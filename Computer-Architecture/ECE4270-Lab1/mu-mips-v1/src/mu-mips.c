@@ -3,9 +3,32 @@
 #include <string.h>
 #include <stdint.h>
 #include <assert.h>
+#include <strings.h>
+#include <fenv.h>
 
 #include "mu-mips.h"
 
+/* memory will be dynamically allocated at initialization (per thread, so worker threads can each own a machine) */
+__thread mem_region_t MEM_REGIONS[NUM_MEM_REGION] = {
+	{ MEM_TEXT_BEGIN, MEM_TEXT_END, NULL, NULL },
+	{ MEM_DATA_BEGIN, MEM_DATA_END, NULL, NULL },
+	{ MEM_KDATA_BEGIN, MEM_KDATA_END, NULL, NULL },
+	{ MEM_KTEXT_BEGIN, MEM_KTEXT_END, NULL, NULL }
+};
+
+__thread CPU_State CURRENT_STATE, NEXT_STATE;
+__thread int RUN_FLAG;
+__thread uint64_t INSTRUCTION_COUNT;
+__thread int TRACE_FLAG = TRUE;
+__thread int QUIET_FLAG;
+uint32_t PROGRAM_SIZE;
+char prog_file[256];
+
+__thread int FAULT_FLAG;
+__thread uint32_t FAULT_ADDR;
+__thread uint32_t *DIRTY_PAGES;
+__thread uint32_t DIRTY_COUNT, DIRTY_CAPACITY;
+
 /***************************************************************/
 /* Print out a list of commands available                                                                  */
 /***************************************************************/
@@ -16,11 +39,31 @@ void help() {
 	printf("run <n>\t-- simulate program for <n> instructions\n");
 	printf("rdump\t-- dump register values\n");
 	printf("reset\t-- clears all registers/memory and re-loads the program\n");
+	printf("rstep <n>\t-- step backwards <n> instructions\n");
+	printf("rcontinue\t-- run backwards to the previous breakpoint\n");
+	printf("break <addr>\t-- set/clear a breakpoint\n");
+	printf("journal on|off|<MB>\t-- record history for rstep/rcontinue (off by default; <MB> sets its memory budget)\n");
 	printf("input <reg> <val>\t-- set GPR <reg> to <val>\n");
 	printf("mdump <start> <stop>\t-- dump memory from <start> to <stop> address\n");
 	printf("high <val>\t-- set the HI register to <val>\n");
 	printf("low <val>\t-- set the LO register to <val>\n");
 	printf("print\t-- print the program loaded into memory\n");
+	printf("trace\t-- toggle printing of each executed instruction\n");
+	printf("telemetry socket|file <path> <ms>\t-- publish live counters (see mu-telemetry); telemetry off|stats\n");
+	printf("stats\t-- host performance counters for the last run/sim\n");
+	printf("summary\t-- toggle printing stats after every run/sim\n");
+	printf("ooo on|off|stats|reset\t-- out-of-order timing model\n");
+	printf("ooo set <param> <val>\t-- configure widths, rob/rs/lsq/prf, units and lat_* latencies\n");
+	printf("interval <n> <workers>\t-- run to completion, re-simulating each <n>-instruction interval in parallel on the timing model\n");
+	printf("wcet report\t-- static worst-case cycle bound and hot path of the loaded program\n");
+	printf("wcet bound <addr> <n>\t-- loop headed at <addr> runs at most <n> iterations\n");
+	printf("wcet lat <class> <cycles>\t-- latency of alu|branch|mult|div|load|store|fpu in the analysis\n");
+	printf("ff on|off|stats\t-- skip counted and spin loops in one step (while trace is off)\n");
+	printf("fuzz <secs> <workers>\t-- coverage-guided fuzzing of the loaded program\n");
+	printf("mmu off|on|guest\t-- TLB translation off, refilled by the simulator, or by the guest\n");
+	printf("mmu stats|tlb\t-- TLB miss report, dump TLB entries\n");
+	printf("fpu regs\t-- dump FP registers and FCSR\n");
+	printf("fpu strict|auto\t-- force the strict IEEE path, or only when FCSR needs it\n");
 	printf("?\t-- display help menu\n");
 	printf("quit\t-- exit the simulator\n\n");
 	printf("------------------------------------------------------------------\n\n");
@@ -33,7 +76,7 @@ uint32_t mem_read_32(uint32_t address)
 {
 	int i;
 	for (i = 0; i < NUM_MEM_REGION; i++) {
-		if ( (address >= MEM_REGIONS[i].begin) &&  ( address <= MEM_REGIONS[i].end) ) {
+		if ( (address >= MEM_REGIONS[i].begin) &&  ( address <= MEM_REGIONS[i].end - 3) ) {
 			uint32_t offset = address - MEM_REGIONS[i].begin;
 			return (MEM_REGIONS[i].mem[offset+3] << 24) |
 					(MEM_REGIONS[i].mem[offset+2] << 16) |
@@ -41,6 +84,11 @@ uint32_t mem_read_32(uint32_t address)
 					(MEM_REGIONS[i].mem[offset+0] <<  0);
 		}
 	}
+	if ((address & ~(MEM_PAGE_SIZE - 1)) == MEM_COUNTERS_BEGIN) {
+		return counters_read(address);
+	}
+	FAULT_FLAG = FAULT_UNMAPPED;
+	FAULT_ADDR = address;
 	return 0;
 }
 
@@ -52,24 +100,78 @@ void mem_write_32(uint32_t address, uint32_t value)
 	int i;
 	uint32_t offset;
 	for (i = 0; i < NUM_MEM_REGION; i++) {
-		if ( (address >= MEM_REGIONS[i].begin) && (address <= MEM_REGIONS[i].end) ) {
+		if ( (address >= MEM_REGIONS[i].begin) && (address <= MEM_REGIONS[i].end - 3) ) {
 			offset = address - MEM_REGIONS[i].begin;
+			if (JOURNAL != NULL) {
+				journal_record(&MEM_REGIONS[i].mem[offset]);
+			}
 
 			MEM_REGIONS[i].mem[offset+3] = (value >> 24) & 0xFF;
 			MEM_REGIONS[i].mem[offset+2] = (value >> 16) & 0xFF;
 			MEM_REGIONS[i].mem[offset+1] = (value >>  8) & 0xFF;
 			MEM_REGIONS[i].mem[offset+0] = (value >>  0) & 0xFF;
+			mem_mark_dirty(i, offset);
+			mem_mark_dirty(i, offset + 3);
+			return;
+		}
+	}
+	FAULT_FLAG = FAULT_UNMAPPED;
+	FAULT_ADDR = address;
+}
+
+/***************************************************************/
+/* Read a word at a virtual address: micro-TLB hit, or the slow path          */
+/***************************************************************/
+static inline uint32_t vmem_read_32(uint32_t address)
+{
+	utlb_entry_t *e = &UTLB_READ[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)];
+	uint8_t *p;
+
+	if (e->tag == (UTLB_GEN | (address & ~(MEM_PAGE_SIZE - 1))) && (address & (MEM_PAGE_SIZE - 1)) <= MEM_PAGE_SIZE - 4) {
+		p = e->host + (address & (MEM_PAGE_SIZE - 1));
+		return (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+	}
+	return vmem_read_slow(address);
+}
+
+/***************************************************************/
+/* Write a word at a virtual address: micro-TLB hit, or the slow path         */
+/***************************************************************/
+static inline void vmem_write_32(uint32_t address, uint32_t value)
+{
+	utlb_entry_t *e = &UTLB_WRITE[(address >> MEM_PAGE_SHIFT) & (UTLB_SIZE - 1)];
+	uint8_t *p;
+
+	if (e->tag == (UTLB_GEN | (address & ~(MEM_PAGE_SIZE - 1))) && (address & (MEM_PAGE_SIZE - 1)) <= MEM_PAGE_SIZE - 4) {
+		p = e->host + (address & (MEM_PAGE_SIZE - 1));
+		if (JOURNAL != NULL) {
+			journal_record(p);
 		}
+		p[3] = (value >> 24) & 0xFF;
+		p[2] = (value >> 16) & 0xFF;
+		p[1] = (value >>  8) & 0xFF;
+		p[0] = (value >>  0) & 0xFF;
+		return;
 	}
+	vmem_write_slow(address, value);
 }
 
 /***************************************************************/
 /* Execute one cycle                                                                                                              */
 /***************************************************************/
 void cycle() {                                                
+	if (JOURNAL != NULL) {
+		journal_begin_step();
+	}
 	handle_instruction();
+	if (OOO_MODEL != NULL) {
+		ooo_instruction(CURRENT_STATE.PC, NEXT_STATE.PC);
+	}
 	CURRENT_STATE = NEXT_STATE;
 	INSTRUCTION_COUNT++;
+	if (INSTRUCTION_COUNT >= NEXT_EVENT) {
+		event_dispatch();
+	}
 }
 
 /***************************************************************/
@@ -84,28 +186,54 @@ void run(int num_cycles) {
 
 	printf("Running simulator for %d cycles...\n\n", num_cycles);
 	int i;
+	uint32_t pc, elided;
+	perf_begin();
+	feclearexcept(FE_ALL_EXCEPT); /* host FP flags raised from here on are the guest's */
 	for (i = 0; i < num_cycles; i++) {
 		if (RUN_FLAG == FALSE) {
 			printf("Simulation Stopped.\n\n");
 			break;
 		}
+		pc = CURRENT_STATE.PC;
 		cycle();
+		fast_forward(pc, num_cycles - i - 1, &elided);
+		i += elided;
+		if (NUM_BREAKPOINTS > 0 && is_breakpoint(CURRENT_STATE.PC)) {
+			printf("Breakpoint at 0x%08x\n\n", CURRENT_STATE.PC);
+			break;
+		}
 	}
+	fpu_sync();
+	perf_end();
 }
 
 /***************************************************************/
 /* simulate to completion                                                                                               */
 /***************************************************************/
 void runAll() {                                                     
+	uint32_t pc, elided;
+
 	if (RUN_FLAG == FALSE) {
 		printf("Simulation Stopped.\n\n");
 		return;
 	}
 
 	printf("Simulation Started...\n\n");
+	perf_begin();
+	feclearexcept(FE_ALL_EXCEPT);
 	while (RUN_FLAG){
+		pc = CURRENT_STATE.PC;
 		cycle();
+		if (!fast_forward(pc, FF_UNLIMITED, &elided)) {
+			break;
+		}
+		if (NUM_BREAKPOINTS > 0 && is_breakpoint(CURRENT_STATE.PC)) {
+			printf("Breakpoint at 0x%08x\n", CURRENT_STATE.PC);
+			break;
+		}
 	}
+	fpu_sync();
+	perf_end();
 	printf("Simulation Finished.\n\n");
 }
 
@@ -133,7 +261,7 @@ void rdump() {
 	printf("-------------------------------------\n");
 	printf("Dumping Register Content\n");
 	printf("-------------------------------------\n");
-	printf("# Instructions Executed\t: %u\n", INSTRUCTION_COUNT);
+	printf("# Instructions Executed\t: %llu\n", (unsigned long long)INSTRUCTION_COUNT);
 	printf("PC\t: 0x%08x\n", CURRENT_STATE.PC);
 	printf("-------------------------------------\n");
 	printf("[Register]\t[Value]\n");
@@ -156,6 +284,9 @@ void handle_command() {
 	uint32_t register_no;
 	int register_value;
 	int hi_reg_value, lo_reg_value;
+	int fuzz_seconds, fuzz_workers;
+	uint32_t interval_length;
+	int interval_workers;
 
 	printf("MU-MIPS SIM:> ");
 
@@ -166,10 +297,22 @@ void handle_command() {
 	switch(buffer[0]) {
 		case 'S':
 		case 's':
-			runAll(); 
+			if (strcasecmp(buffer, "stats") == 0){
+				perf_report();
+			}else if (strcasecmp(buffer, "summary") == 0){
+				PERF_SUMMARY = !PERF_SUMMARY;
+				printf("Run summary %s.\n\n", PERF_SUMMARY ? "on" : "off");
+			}
+			else {
+				runAll(); 
+			}
 			break;
 		case 'M':
 		case 'm':
+			if (strcasecmp(buffer, "mmu") == 0){
+				mmu_command();
+				break;
+			}
 			if (scanf("%x %x", &start, &stop) != 2){
 				break;
 			}
@@ -190,6 +333,13 @@ void handle_command() {
 				rdump();
 			}else if(buffer[1] == 'e' || buffer[1] == 'E'){
 				reset();
+			}else if(strcasecmp(buffer, "rstep") == 0){
+				if (scanf("%u", &cycles) != 1) {
+					break;
+				}
+				rstep(cycles);
+			}else if(strcasecmp(buffer, "rcontinue") == 0){
+				rcontinue();
 			}
 			else {
 				if (scanf("%d", &cycles) != 1) {
@@ -200,11 +350,21 @@ void handle_command() {
 			break;
 		case 'I':
 		case 'i':
+			if (strcasecmp(buffer, "interval") == 0){
+				if (scanf("%u %d", &interval_length, &interval_workers) != 2){
+					break;
+				}
+				interval_run(interval_length, interval_workers);
+				break;
+			}
 			if (scanf("%u %i", &register_no, &register_value) != 2){
 				break;
 			}
 			CURRENT_STATE.REGS[register_no] = register_value;
 			NEXT_STATE.REGS[register_no] = register_value;
+			if (JOURNAL != NULL){
+				journal_clear(); /*history can't be replayed past a manual edit*/
+			}
 			break;
 		case 'H':
 		case 'h':
@@ -213,6 +373,9 @@ void handle_command() {
 			}
 			CURRENT_STATE.HI = hi_reg_value; 
 			NEXT_STATE.HI = hi_reg_value; 
+			if (JOURNAL != NULL){
+				journal_clear();
+			}
 			break;
 		case 'L':
 		case 'l':
@@ -221,11 +384,66 @@ void handle_command() {
 			}
 			CURRENT_STATE.LO = lo_reg_value;
 			NEXT_STATE.LO = lo_reg_value;
+			if (JOURNAL != NULL){
+				journal_clear();
+			}
 			break;
 		case 'P':
 		case 'p':
 			print_program(); 
 			break;
+		case 'T':
+		case 't':
+			if (strcasecmp(buffer, "telemetry") == 0){
+				telemetry_command();
+				break;
+			}
+			TRACE_FLAG = !TRACE_FLAG;
+			printf("Instruction trace %s.\n\n", TRACE_FLAG ? "on" : "off");
+			break;
+		case 'B':
+		case 'b':
+			if (scanf("%x", &start) != 1){
+				break;
+			}
+			toggle_breakpoint(start);
+			break;
+		case 'J':
+		case 'j':
+			journal_command();
+			break;
+		case 'O':
+		case 'o':
+			ooo_command();
+			break;
+		case 'W':
+		case 'w':
+			wcet_command();
+			break;
+		case 'F':
+		case 'f':
+			if (strcasecmp(buffer, "ff") == 0){
+				if (scanf("%19s", buffer) != 1){
+					break;
+				}
+				if (strcasecmp(buffer, "stats") == 0){
+					ff_report();
+				}else{
+					FF_FLAG = strcasecmp(buffer, "off") != 0;
+					memset(FF.reject, 0, sizeof(FF.reject));
+					printf("Loop fast-forward %s.\n\n", FF_FLAG ? "on" : "off");
+				}
+				break;
+			}
+			if (strcasecmp(buffer, "fpu") == 0){
+				fpu_command();
+				break;
+			}
+			if (scanf("%d %d", &fuzz_seconds, &fuzz_workers) != 2){
+				break;
+			}
+			fuzz(fuzz_seconds, fuzz_workers);
+			break;
 		default:
 			printf("Invalid Command.\n");
 			break;
@@ -244,10 +462,8 @@ void reset() {
 	CURRENT_STATE.HI = 0;
 	CURRENT_STATE.LO = 0;
 	
-	for (i = 0; i < NUM_MEM_REGION; i++) {
-		uint32_t region_size = MEM_REGIONS[i].end - MEM_REGIONS[i].begin + 1;
-		memset(MEM_REGIONS[i].mem, 0, region_size);
-	}
+	/*only pages written since the last reset can be non-zero*/
+	clear_memory();
 	
 	/*load program*/
 	load_program();
@@ -257,6 +473,15 @@ void reset() {
 	CURRENT_STATE.PC =  MEM_TEXT_BEGIN;
 	NEXT_STATE = CURRENT_STATE;
 	RUN_FLAG = TRUE;
+	cp0_reset();
+	fpu_reset();
+	memset(&FF, 0, sizeof(FF));
+	if (OOO_MODEL != NULL) {
+		ooo_reset();
+	}
+	if (JOURNAL != NULL) {
+		journal_clear();
+	}
 }
 
 /***************************************************************/
@@ -266,9 +491,170 @@ void init_memory() {
 	int i;
 	for (i = 0; i < NUM_MEM_REGION; i++) {
 		uint32_t region_size = MEM_REGIONS[i].end - MEM_REGIONS[i].begin + 1;
-		MEM_REGIONS[i].mem = malloc(region_size);
-		memset(MEM_REGIONS[i].mem, 0, region_size);
+		/* calloc lets the host hand out zero pages lazily instead of touching 4 GB */
+		MEM_REGIONS[i].mem = calloc(region_size, 1);
+		MEM_REGIONS[i].dirty = calloc((region_size >> MEM_PAGE_SHIFT) / 8 + 1, 1);
+		if (MEM_REGIONS[i].mem == NULL || MEM_REGIONS[i].dirty == NULL) {
+			printf("Error: Can't allocate simulator memory\n");
+			exit(-1);
+		}
+	}
+	DIRTY_COUNT = 0;
+	utlb_flush();
+}
+
+/***************************************************************/
+/* Release this thread's simulator memory                                                             */
+/***************************************************************/
+void free_memory() {
+	int i;
+	for (i = 0; i < NUM_MEM_REGION; i++) {
+		free(MEM_REGIONS[i].mem);
+		free(MEM_REGIONS[i].dirty);
+		MEM_REGIONS[i].mem = NULL;
+		MEM_REGIONS[i].dirty = NULL;
+	}
+	free(DIRTY_PAGES);
+	DIRTY_PAGES = NULL;
+	DIRTY_COUNT = DIRTY_CAPACITY = 0;
+	utlb_flush();
+}
+
+/***************************************************************/
+/* Record that the page holding <offset> in <region> was written                         */
+/***************************************************************/
+void mem_mark_dirty(int region, uint32_t offset) {
+	uint32_t page = offset >> MEM_PAGE_SHIFT;
+	uint8_t bit = 1 << (page & 7);
+
+	if (MEM_REGIONS[region].dirty[page >> 3] & bit) {
+		return;
+	}
+	MEM_REGIONS[region].dirty[page >> 3] |= bit;
+	if (DIRTY_COUNT == DIRTY_CAPACITY) {
+		DIRTY_CAPACITY = DIRTY_CAPACITY ? DIRTY_CAPACITY * 2 : 64;
+		DIRTY_PAGES = realloc(DIRTY_PAGES, DIRTY_CAPACITY * sizeof(uint32_t));
+		assert(DIRTY_PAGES != NULL);
+	}
+	DIRTY_PAGES[DIRTY_COUNT++] = MEM_PAGE_ID(region, page);
+}
+
+/***************************************************************/
+/* Zero every page written since the last reset                                                     */
+/***************************************************************/
+void clear_memory() {
+	uint32_t i, region, page;
+	for (i = 0; i < DIRTY_COUNT; i++) {
+		region = DIRTY_PAGES[i] >> 20;
+		page = DIRTY_PAGES[i] & 0xFFFFF;
+		memset(MEM_REGIONS[region].mem + (page << MEM_PAGE_SHIFT), 0, MEM_PAGE_SIZE);
+		MEM_REGIONS[region].dirty[page >> 3] &= ~(1 << (page & 7));
+	}
+	DIRTY_COUNT = 0;
+	/* cached write pages are no longer dirty */
+	utlb_flush();
+}
+
+/***************************************************************/
+/* Copy every non-zero page of memory into <snap>                                                  */
+/***************************************************************/
+void mem_snapshot_take(mem_snapshot_t *snap) {
+	uint32_t i, region, page;
+
+	snap->count = DIRTY_COUNT;
+	snap->pages = malloc(DIRTY_COUNT * sizeof(uint32_t));
+	snap->data = malloc((size_t)DIRTY_COUNT * MEM_PAGE_SIZE);
+	assert(DIRTY_COUNT == 0 || (snap->pages != NULL && snap->data != NULL));
+	for (i = 0; i < DIRTY_COUNT; i++) {
+		region = DIRTY_PAGES[i] >> 20;
+		page = DIRTY_PAGES[i] & 0xFFFFF;
+		snap->pages[i] = DIRTY_PAGES[i];
+		memcpy(snap->data + (size_t)i * MEM_PAGE_SIZE, MEM_REGIONS[region].mem + (page << MEM_PAGE_SHIFT), MEM_PAGE_SIZE);
+	}
+}
+
+/***************************************************************/
+/* Return memory to the state captured in <snap>, touching only dirty pages             */
+/***************************************************************/
+void mem_snapshot_restore(const mem_snapshot_t *snap) {
+	uint32_t i, region, page;
+
+	clear_memory();
+	for (i = 0; i < snap->count; i++) {
+		region = snap->pages[i] >> 20;
+		page = snap->pages[i] & 0xFFFFF;
+		memcpy(MEM_REGIONS[region].mem + (page << MEM_PAGE_SHIFT), snap->data + (size_t)i * MEM_PAGE_SIZE, MEM_PAGE_SIZE);
+		mem_mark_dirty(region, page << MEM_PAGE_SHIFT);
+	}
+}
+
+/***************************************************************/
+/* TRUE if memory holds exactly the contents captured in <snap>                          */
+/***************************************************************/
+int mem_snapshot_matches(const mem_snapshot_t *snap) {
+	uint32_t i, region, page, nonzero = 0;
+	const uint8_t *mem;
+
+	for (i = 0; i < snap->count; i++) {
+		region = snap->pages[i] >> 20;
+		page = snap->pages[i] & 0xFFFFF;
+		mem = MEM_REGIONS[region].mem + (page << MEM_PAGE_SHIFT);
+		if (memcmp(mem, snap->data + (size_t)i * MEM_PAGE_SIZE, MEM_PAGE_SIZE) != 0) {
+			return FALSE;
+		}
+		if (mem[0] != 0 || memcmp(mem, mem + 1, MEM_PAGE_SIZE - 1) != 0) {
+			nonzero++;
+		}
+	}
+	/* every non-zero page of <snap> matched, so any further non-zero page is a mismatch */
+	for (i = 0; i < DIRTY_COUNT; i++) {
+		mem = MEM_REGIONS[DIRTY_PAGES[i] >> 20].mem + ((DIRTY_PAGES[i] & 0xFFFFF) << MEM_PAGE_SHIFT);
+		if (mem[0] != 0 || memcmp(mem, mem + 1, MEM_PAGE_SIZE - 1) != 0) {
+			if (nonzero-- == 0) {
+				return FALSE;
+			}
+		}
+	}
+	return nonzero == 0;
+}
+
+void mem_snapshot_free(mem_snapshot_t *snap) {
+	free(snap->pages);
+	free(snap->data);
+	snap->pages = NULL;
+	snap->data = NULL;
+	snap->count = 0;
+}
+
+/***************************************************************/
+/* Host page backing physical page <physical>, or NULL (unmapped/MMIO)  */
+/***************************************************************/
+uint8_t *mem_host_page(uint32_t physical)
+{
+	int i;
+	physical &= ~(MEM_PAGE_SIZE - 1);
+	for (i = 0; i < NUM_MEM_REGION; i++) {
+		if ( (physical >= MEM_REGIONS[i].begin) && (physical <= MEM_REGIONS[i].end - (MEM_PAGE_SIZE - 1)) ) {
+			return MEM_REGIONS[i].mem + (physical - MEM_REGIONS[i].begin);
+		}
+	}
+	return NULL;
+}
+
+/***************************************************************/
+/* TRUE if the page holding <physical> was written since the last reset  */
+/***************************************************************/
+int mem_page_written(uint32_t physical)
+{
+	int i;
+	uint32_t page;
+	for (i = 0; i < NUM_MEM_REGION; i++) {
+		if ( (physical >= MEM_REGIONS[i].begin) && (physical <= MEM_REGIONS[i].end) ) {
+			page = (physical - MEM_REGIONS[i].begin) >> MEM_PAGE_SHIFT;
+			return (MEM_REGIONS[i].dirty[page >> 3] >> (page & 7)) & 1;
+		}
 	}
+	return FALSE;
 }
 
 /**************************************************************/
@@ -292,11 +678,11 @@ void load_program() {
 	while( fscanf(fp, "%x\n", &word) != EOF ) {
 		address = MEM_TEXT_BEGIN + i;
 		mem_write_32(address, word);
-		printf("writing 0x%08x into address 0x%08x (%d)\n", word, address, address);
+		if (TRACE_FLAG) printf("writing 0x%08x into address 0x%08x (%d)\n", word, address, address);
 		i += 4;
 	}
 	PROGRAM_SIZE = i/4;
-	printf("Program loaded into memory.\n%d words written into memory.\n\n", PROGRAM_SIZE);
+	if (TRACE_FLAG) printf("Program loaded into memory.\n%d words written into memory.\n\n", PROGRAM_SIZE);
 	fclose(fp);
 }
 
@@ -312,13 +698,16 @@ void handle_instruction()
 	uint32_t instruction, opcode, function, rs, rt, rd, sa, immediate, target;
 	uint64_t product, p1, p2;
 	
-	uint32_t addr, data;
+	uint32_t addr, data, data_hi;
 	
 	int branch_jump = FALSE;
 	
-	printf("[0x%x]\t", CURRENT_STATE.PC);
+	if(TRACE_FLAG) printf("[0x%x]\t", CURRENT_STATE.PC);
 	
-	instruction = mem_read_32(CURRENT_STATE.PC);
+	instruction = vmem_read_32(CURRENT_STATE.PC);
+	if(EXCEPTION_PENDING){
+		instruction = 0; /*fetch faulted: execute nothing*/
+	}
 	
 	opcode = (instruction & 0xFC000000) >> 26;
 	function = instruction & 0x0000003F;
@@ -333,11 +722,11 @@ void handle_instruction()
 		switch(function){
 			case 0x00: //SLL
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rt] << sa;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x02: //SRL
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rt] >> sa;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x03: //SRA 
 				if ((CURRENT_STATE.REGS[rt] & 0x80000000) == 1)
@@ -347,40 +736,40 @@ void handle_instruction()
 				else{
 					NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rt] >> sa;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x08: //JR
 				NEXT_STATE.PC = CURRENT_STATE.REGS[rs];
 				branch_jump = TRUE;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x09: //JALR
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.PC + 4;
 				NEXT_STATE.PC = CURRENT_STATE.REGS[rs];
 				branch_jump = TRUE;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0C: //SYSCALL
 				if(CURRENT_STATE.REGS[2] == 0xa){
 					RUN_FLAG = FALSE;
-					print_instruction(CURRENT_STATE.PC);
+					if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				}
 				break;
 			case 0x10: //MFHI
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.HI;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x11: //MTHI
 				NEXT_STATE.HI = CURRENT_STATE.REGS[rs];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x12: //MFLO
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.LO;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x13: //MTLO
 				NEXT_STATE.LO = CURRENT_STATE.REGS[rs];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x18: //MULT
 				if ((CURRENT_STATE.REGS[rs] & 0x80000000) == 0x80000000){
@@ -396,13 +785,13 @@ void handle_instruction()
 				product = p1 * p2;
 				NEXT_STATE.LO = (product & 0X00000000FFFFFFFF);
 				NEXT_STATE.HI = (product & 0XFFFFFFFF00000000)>>32;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x19: //MULTU
 				product = (uint64_t)CURRENT_STATE.REGS[rs] * (uint64_t)CURRENT_STATE.REGS[rt];
 				NEXT_STATE.LO = (product & 0X00000000FFFFFFFF);
 				NEXT_STATE.HI = (product & 0XFFFFFFFF00000000)>>32;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x1A: //DIV 
 				if(CURRENT_STATE.REGS[rt] != 0)
@@ -410,7 +799,7 @@ void handle_instruction()
 					NEXT_STATE.LO = (int32_t)CURRENT_STATE.REGS[rs] / (int32_t)CURRENT_STATE.REGS[rt];
 					NEXT_STATE.HI = (int32_t)CURRENT_STATE.REGS[rs] % (int32_t)CURRENT_STATE.REGS[rt];
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x1B: //DIVU
 				if(CURRENT_STATE.REGS[rt] != 0)
@@ -418,39 +807,39 @@ void handle_instruction()
 					NEXT_STATE.LO = CURRENT_STATE.REGS[rs] / CURRENT_STATE.REGS[rt];
 					NEXT_STATE.HI = CURRENT_STATE.REGS[rs] % CURRENT_STATE.REGS[rt];
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x20: //ADD
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] + CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x21: //ADDU 
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rt] + CURRENT_STATE.REGS[rs];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x22: //SUB
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] - CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x23: //SUBU
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] - CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x24: //AND
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] & CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x25: //OR
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] | CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x26: //XOR
 				NEXT_STATE.REGS[rd] = CURRENT_STATE.REGS[rs] ^ CURRENT_STATE.REGS[rt];
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x27: //NOR
 				NEXT_STATE.REGS[rd] = ~(CURRENT_STATE.REGS[rs] | CURRENT_STATE.REGS[rt]);
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x2A: //SLT
 				if(CURRENT_STATE.REGS[rs] < CURRENT_STATE.REGS[rt]){
@@ -459,10 +848,12 @@ void handle_instruction()
 				else{
 					NEXT_STATE.REGS[rd] = 0x0;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			default:
-				printf("Instruction at 0x%x is not implemented!\n", CURRENT_STATE.PC);
+				if(TRACE_FLAG) printf("Instruction at 0x%x is not implemented!\n", CURRENT_STATE.PC);
+				FAULT_FLAG = FAULT_ILLEGAL;
+				FAULT_ADDR = CURRENT_STATE.PC;
 				break;
 		}
 	}
@@ -474,62 +865,62 @@ void handle_instruction()
 						NEXT_STATE.PC = CURRENT_STATE.PC + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 						branch_jump = TRUE;
 					}
-					print_instruction(CURRENT_STATE.PC);
+					if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				}
 				else if(rt == 0x00001){ //BGEZ
 					if((CURRENT_STATE.REGS[rs] & 0x80000000) == 0x0){
 						NEXT_STATE.PC = CURRENT_STATE.PC + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 						branch_jump = TRUE;
 					}
-					print_instruction(CURRENT_STATE.PC);
+					if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				}
 				break;
 			case 0x02: //J
 				NEXT_STATE.PC = (CURRENT_STATE.PC & 0xF0000000) | (target << 2);
 				branch_jump = TRUE;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x03: //JAL
 				NEXT_STATE.PC = (CURRENT_STATE.PC & 0xF0000000) | (target << 2);
 				NEXT_STATE.REGS[31] = CURRENT_STATE.PC + 4;
 				branch_jump = TRUE;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x04: //BEQ
 				if(CURRENT_STATE.REGS[rs] == CURRENT_STATE.REGS[rt]){
 					NEXT_STATE.PC = CURRENT_STATE.PC + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 					branch_jump = TRUE;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x05: //BNE
 				if(CURRENT_STATE.REGS[rs] != CURRENT_STATE.REGS[rt]){
 					NEXT_STATE.PC = CURRENT_STATE.PC + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 					branch_jump = TRUE;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x06: //BLEZ
 				if((CURRENT_STATE.REGS[rs] & 0x80000000) > 0 || CURRENT_STATE.REGS[rs] == 0){
 					NEXT_STATE.PC = CURRENT_STATE.PC +  ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 					branch_jump = TRUE;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x07: //BGTZ
-				if((CURRENT_STATE.REGS[rs] & 0x80000000) == 0x0 || CURRENT_STATE.REGS[rs] != 0){
+				if((CURRENT_STATE.REGS[rs] & 0x80000000) == 0x0 && CURRENT_STATE.REGS[rs] != 0){
 					NEXT_STATE.PC = CURRENT_STATE.PC +  ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000)<<2 : (immediate & 0x0000FFFF)<<2);
 					branch_jump = TRUE;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x08: //ADDI
 				NEXT_STATE.REGS[rt] = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x09: //ADDIU
 				NEXT_STATE.REGS[rt] = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0A: //SLTI
 				if ( (  (int32_t)CURRENT_STATE.REGS[rs] - (int32_t)( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF))) < 0){
@@ -537,60 +928,167 @@ void handle_instruction()
 				}else{
 					NEXT_STATE.REGS[rt] = 0x0;
 				}
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0C: //ANDI
 				NEXT_STATE.REGS[rt] = CURRENT_STATE.REGS[rs] & (immediate & 0x0000FFFF);
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0D: //ORI
 				NEXT_STATE.REGS[rt] = CURRENT_STATE.REGS[rs] | (immediate & 0x0000FFFF);
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0E: //XORI
 				NEXT_STATE.REGS[rt] = CURRENT_STATE.REGS[rs] ^ (immediate & 0x0000FFFF);
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x0F: //LUI
 				NEXT_STATE.REGS[rt] = immediate << 16;
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x10: //COP0: MFC0, MTC0, TLBR, TLBWI, TLBWR, TLBP, ERET
+				if(handle_cop0(instruction)){
+					branch_jump = TRUE;
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x11: //COP1: MFC1, MTC1, CFC1, CTC1, BC1T/F, S/D/W arithmetic, conversions and compares
+				if(handle_cop1(instruction)){
+					branch_jump = TRUE;
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x20: //LB
-				data = mem_read_32( CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF)) );
+				data = vmem_read_32( CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF)) );
 				NEXT_STATE.REGS[rt] = ((data & 0x000000FF) & 0x80) > 0 ? (data | 0xFFFFFF00) : (data & 0x000000FF);
-				print_instruction(CURRENT_STATE.PC);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x21: //LH
-				data = mem_read_32( CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF)) );
-				NEXT_STATE.REGS[rt] = ((data & 0x0000FFFF) & 0x8000) > 0 ? (data | 0xFFFF0000) : (data & 0x0000FFFF);
-				print_instruction(CURRENT_STATE.PC);
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(addr & 0x1){
+					FAULT_FLAG = FAULT_UNALIGNED;
+					FAULT_ADDR = addr;
+				}
+				else{
+					data = vmem_read_32(addr);
+					NEXT_STATE.REGS[rt] = ((data & 0x0000FFFF) & 0x8000) > 0 ? (data | 0xFFFF0000) : (data & 0x0000FFFF);
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x23: //LW
-				NEXT_STATE.REGS[rt] = mem_read_32( CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF)) );
-				print_instruction(CURRENT_STATE.PC);
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(addr & 0x3){
+					FAULT_FLAG = FAULT_UNALIGNED;
+					FAULT_ADDR = addr;
+				}
+				else{
+					NEXT_STATE.REGS[rt] = vmem_read_32(addr);
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x28: //SB
 				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
-				data = mem_read_32( addr);
+				data = vmem_read_32( addr);
 				data = (data & 0xFFFFFF00) | (CURRENT_STATE.REGS[rt] & 0x000000FF);
-				mem_write_32(addr, data);
-				print_instruction(CURRENT_STATE.PC);				
+				if(!EXCEPTION_PENDING) vmem_write_32(addr, data);
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);				
 				break;
 			case 0x29: //SH
 				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
-				data = mem_read_32( addr);
-				data = (data & 0xFFFF0000) | (CURRENT_STATE.REGS[rt] & 0x0000FFFF);
-				mem_write_32(addr, data);
-				print_instruction(CURRENT_STATE.PC);
+				if(addr & 0x1){
+					FAULT_FLAG = FAULT_UNALIGNED;
+					FAULT_ADDR = addr;
+				}
+				else{
+					data = vmem_read_32( addr);
+					data = (data & 0xFFFF0000) | (CURRENT_STATE.REGS[rt] & 0x0000FFFF);
+					if(!EXCEPTION_PENDING) vmem_write_32(addr, data);
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			case 0x2B: //SW
 				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
-				mem_write_32(addr, CURRENT_STATE.REGS[rt]);
-				print_instruction(CURRENT_STATE.PC);
+				if(addr & 0x3){
+					FAULT_FLAG = FAULT_UNALIGNED;
+					FAULT_ADDR = addr;
+				}
+				else{
+					vmem_write_32(addr, CURRENT_STATE.REGS[rt]);
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x31: //LWC1
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(fpu_usable()){
+					if(addr & 0x3){
+						FAULT_FLAG = FAULT_UNALIGNED;
+						FAULT_ADDR = addr;
+					}
+					else{
+						data = vmem_read_32(addr);
+						if(!EXCEPTION_PENDING) FPR[rt] = data;
+					}
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x35: //LDC1
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(rt & 1){
+					FAULT_FLAG = FAULT_ILLEGAL;
+					FAULT_ADDR = CURRENT_STATE.PC;
+				}
+				else if(fpu_usable()){
+					if(addr & 0x7){
+						FAULT_FLAG = FAULT_UNALIGNED;
+						FAULT_ADDR = addr;
+					}
+					else{
+						data = vmem_read_32(addr);
+						data_hi = vmem_read_32(addr + 4);
+						if(!EXCEPTION_PENDING){
+							FPR[rt] = data;
+							FPR[rt + 1] = data_hi;
+						}
+					}
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x39: //SWC1
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(fpu_usable()){
+					if(addr & 0x3){
+						FAULT_FLAG = FAULT_UNALIGNED;
+						FAULT_ADDR = addr;
+					}
+					else{
+						vmem_write_32(addr, FPR[rt]);
+					}
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
+				break;
+			case 0x3D: //SDC1
+				addr = CURRENT_STATE.REGS[rs] + ( (immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) : (immediate & 0x0000FFFF));
+				if(rt & 1){
+					FAULT_FLAG = FAULT_ILLEGAL;
+					FAULT_ADDR = CURRENT_STATE.PC;
+				}
+				else if(fpu_usable()){
+					if(addr & 0x7){
+						FAULT_FLAG = FAULT_UNALIGNED;
+						FAULT_ADDR = addr;
+					}
+					else{
+						vmem_write_32(addr, FPR[rt]);
+						if(!EXCEPTION_PENDING) vmem_write_32(addr + 4, FPR[rt + 1]);
+					}
+				}
+				if(TRACE_FLAG) print_instruction(CURRENT_STATE.PC);
 				break;
 			default:
 				// put more things here
-				printf("Instruction at 0x%x is not implemented!\n", CURRENT_STATE.PC);
+				if(TRACE_FLAG) printf("Instruction at 0x%x is not implemented!\n", CURRENT_STATE.PC);
+				FAULT_FLAG = FAULT_ILLEGAL;
+				FAULT_ADDR = CURRENT_STATE.PC;
 				break;
 		}
 	}
@@ -598,6 +1096,18 @@ void handle_instruction()
 	if(!branch_jump){
 		NEXT_STATE.PC = CURRENT_STATE.PC + 4;
 	}
+	
+	/*an exception cancels the instruction and enters the handler*/
+	if(EXCEPTION_PENDING){
+		NEXT_STATE = CURRENT_STATE;
+		NEXT_STATE.PC = EXCEPTION_VECTOR;
+		EXCEPTION_PENDING = FALSE;
+	}
+	
+	/*record the edge taken out of every branch/jump site while fuzzing*/
+	if(COVERAGE_MAP != NULL && ((opcode >= 0x01 && opcode <= 0x07) || (opcode == 0x00 && (function == 0x08 || function == 0x09)) || (opcode == 0x11 && rs == 0x08))){
+		COVERAGE_MAP[(((CURRENT_STATE.PC >> 2) * 0x9E3779B1) ^ (((NEXT_STATE.PC >> 2) * 0x85EBCA6B) >> 1)) & (FUZZ_MAP_SIZE - 1)]++;
+	}
 }
 
 
@@ -609,6 +1119,8 @@ void initialize() {
 	CURRENT_STATE.PC = MEM_TEXT_BEGIN;
 	NEXT_STATE = CURRENT_STATE;
 	RUN_FLAG = TRUE;
+	cp0_reset();
+	fpu_reset();
 }
 
 /************************************************************/
@@ -629,6 +1141,13 @@ void print_program(){
 /* Print the instruction at given memory address (in MIPS assembly format)    */
 /************************************************************/
 void print_instruction(uint32_t addr){
+	static const char *fp_ops[0x28] = {
+		"ADD", "SUB", "MUL", "DIV", "SQRT", "ABS", "MOV", "NEG",
+		NULL, NULL, NULL, NULL, "ROUND.W", "TRUNC.W", "CEIL.W", "FLOOR.W",
+		NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+		"CVT.S", "CVT.D", NULL, NULL, "CVT.W", NULL, NULL, NULL
+	};
+	static const char *fp_conds[16] = { "F", "UN", "EQ", "UEQ", "OLT", "ULT", "OLE", "ULE", "SF", "NGLE", "SEQ", "NGL", "LT", "NGE", "LE", "NGT" };
 	uint32_t instruction, opcode, function, rs, rt, rd, sa, immediate, target;
 	
 	instruction = mem_read_32(addr);
@@ -774,6 +1293,62 @@ void print_instruction(uint32_t addr){
 			case 0x0F:
 				printf("LUI $r%u, 0x%x\n", rt, immediate);
 				break;
+			case 0x10:
+				if(rs == 0x00){
+					printf("MFC0 $r%u, $%u\n", rt, rd);
+				}
+				else if(rs == 0x04){
+					printf("MTC0 $r%u, $%u\n", rt, rd);
+				}
+				else if(function == 0x01){
+					printf("TLBR\n");
+				}
+				else if(function == 0x02){
+					printf("TLBWI\n");
+				}
+				else if(function == 0x06){
+					printf("TLBWR\n");
+				}
+				else if(function == 0x08){
+					printf("TLBP\n");
+				}
+				else if(function == 0x18){
+					printf("ERET\n");
+				}
+				else{
+					printf("COP0 0x%08x\n", instruction);
+				}
+				break;
+			case 0x11:
+				if(rs == 0x00){
+					printf("MFC1 $r%u, $f%u\n", rt, rd);
+				}
+				else if(rs == 0x02){
+					printf("CFC1 $r%u, $%u\n", rt, rd);
+				}
+				else if(rs == 0x04){
+					printf("MTC1 $r%u, $f%u\n", rt, rd);
+				}
+				else if(rs == 0x06){
+					printf("CTC1 $r%u, $%u\n", rt, rd);
+				}
+				else if(rs == 0x08){
+					printf("BC1%s%s 0x%x\n", rt & 1 ? "T" : "F", rt & 2 ? "L" : "", immediate<<2);
+				}
+				else if((rs == FMT_S || rs == FMT_D || rs == FMT_W) && function >= 0x30){
+					printf("C.%s.%s $f%u, $f%u\n", fp_conds[function & 0xF], rs == FMT_S ? "S" : (rs == FMT_D ? "D" : "W"), rd, rt);
+				}
+				else if((rs == FMT_S || rs == FMT_D || rs == FMT_W) && function < 0x28 && fp_ops[function] != NULL){
+					printf("%s.%s $f%u, $f%u", fp_ops[function], rs == FMT_S ? "S" : (rs == FMT_D ? "D" : "W"), sa, rd);
+					if(function < 0x04){
+						printf(", $f%u", rt);
+					}
+					printf("\n");
+				}
+				else{
+					printf("COP1 0x%08x\n", instruction);
+				}
+				break;
 			case 0x20:
 				printf("LB $r%u, 0x%x($r%u)\n", rt, immediate, rs);
 				break;
@@ -792,6 +1367,18 @@ void print_instruction(uint32_t addr){
 			case 0x2B:
 				printf("SW $r%u, 0x%x($r%u)\n", rt, immediate, rs);
 				break;
+			case 0x31:
+				printf("LWC1 $f%u, 0x%x($r%u)\n", rt, immediate, rs);
+				break;
+			case 0x35:
+				printf("LDC1 $f%u, 0x%x($r%u)\n", rt, immediate, rs);
+				break;
+			case 0x39:
+				printf("SWC1 $f%u, 0x%x($r%u)\n", rt, immediate, rs);
+				break;
+			case 0x3D:
+				printf("SDC1 $f%u, 0x%x($r%u)\n", rt, immediate, rs);
+				break;
 			default:
 				printf("Instruction is not implemented!\n");
 				break;
@@ -812,12 +1399,13 @@ int main(int argc, char *argv[]) {
 		exit(1);
 	}
 
-	strcpy(prog_file, argv[1]);
+	strncpy(prog_file, argv[1], sizeof(prog_file) - 1);
 	initialize();
 	load_program();
 	help();
 	while (1){
 		handle_command();
+		telemetry_snapshot();
 	}
 	return 0;
 }
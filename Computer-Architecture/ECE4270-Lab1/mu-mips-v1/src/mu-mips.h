@@ -1,4 +1,7 @@
 #include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
 
 #define FALSE 0
 #define TRUE  1
@@ -18,6 +21,14 @@
 #define MEM_KDATA_BEGIN 0x90000000
 #define MEM_KDATA_END  0xFFFEFFFF
 
+/*read-only counter page past kdata: 64-bit instruction and cycle counts (low word first), Count, Compare;*/
+/*cycles are architectural so replay stays deterministic; `ooo stats` reports the model's*/
+#define MEM_COUNTERS_BEGIN  0xFFFF0000
+#define COUNTERS_INSTRET    0x00
+#define COUNTERS_CYCLE      0x08
+#define COUNTERS_COUNT      0x10
+#define COUNTERS_COMPARE    0x14
+
 /*stack and data segments occupy the same memory space. Stack grows backward (from higher address to lower address) */
 #define MEM_STACK_BEGIN 0x7FFFFFFF
 #define MEM_STACK_END  0x10010000
@@ -25,17 +36,14 @@
 typedef struct {
 	uint32_t begin, end;
 	uint8_t *mem;
+	uint8_t *dirty; /* one bit per page written since the last reset */
 } mem_region_t;
 
-/* memory will be dynamically allocated at initialization */
-mem_region_t MEM_REGIONS[] = {
-	{ MEM_TEXT_BEGIN, MEM_TEXT_END, NULL },
-	{ MEM_DATA_BEGIN, MEM_DATA_END, NULL },
-	{ MEM_KDATA_BEGIN, MEM_KDATA_END, NULL },
-	{ MEM_KTEXT_BEGIN, MEM_KTEXT_END, NULL }
-};
-
 #define NUM_MEM_REGION 4
+
+/* memory will be dynamically allocated at initialization (per thread, so worker threads can each own a machine) */
+extern __thread mem_region_t MEM_REGIONS[NUM_MEM_REGION];
+
 #define MIPS_REGS 32
 
 typedef struct CPU_State_Struct {
@@ -51,17 +59,605 @@ typedef struct CPU_State_Struct {
 /* CPU State info.                                                                                                               */
 /***************************************************************/
 
-CPU_State CURRENT_STATE, NEXT_STATE;
-int RUN_FLAG;	/* run flag*/
-uint32_t INSTRUCTION_COUNT;
-uint32_t PROGRAM_SIZE; /*in words*/
+extern __thread CPU_State CURRENT_STATE, NEXT_STATE;
+extern __thread int RUN_FLAG;	/* run flag*/
+extern __thread uint64_t INSTRUCTION_COUNT; /* also the cycle count: one instruction completes per cycle */
+extern __thread int TRACE_FLAG; /* print each instruction as it executes */
+extern __thread int QUIET_FLAG; /* suppress diagnostics (worker threads) */
+extern uint32_t PROGRAM_SIZE; /*in words*/
+
+extern char prog_file[256];
+
+/***************************************************************/
+/* Coprocessor 0 and the R4400 TLB                                                                        */
+/***************************************************************/
+#define CP0_INDEX     0
+#define CP0_RANDOM    1
+#define CP0_ENTRYLO0  2
+#define CP0_ENTRYLO1  3
+#define CP0_CONTEXT   4
+#define CP0_PAGEMASK  5
+#define CP0_WIRED     6
+#define CP0_BADVADDR  8
+#define CP0_COUNT     9
+#define CP0_ENTRYHI   10
+#define CP0_COMPARE   11
+#define CP0_STATUS    12
+#define CP0_CAUSE     13
+#define CP0_EPC       14
+#define CP0_PRID      15
+#define CP0_CONFIG    16
+#define CP0_ERROREPC  30
+#define CP0_REGS      32
+
+#define CP0_PRID_R4400 0x00000440
+
+#define STATUS_IE       0x00000001
+#define STATUS_EXL      0x00000002
+#define STATUS_ERL      0x00000004
+#define STATUS_KSU      0x00000018
+#define STATUS_KSU_USER 0x00000010
+#define STATUS_IM       0x0000FF00
+#define STATUS_IM7      0x00008000
+#define STATUS_CU1      0x20000000
+#define CAUSE_IP        0x0000FF00
+#define CAUSE_IP7       0x00008000 /* timer: Count reached Compare */
+#define CAUSE_EXCCODE   0x0000007C
+#define CAUSE_CE        0x30000000 /* coprocessor number of a CpU exception */
+#define INDEX_P         0x80000000
+
+#define ENTRYHI_VPN2    0xFFFFE000
+#define ENTRYHI_ASID    0x000000FF
+#define ENTRYLO_PFN     0x3FFFFFC0
+#define ENTRYLO_C       0x00000038
+#define ENTRYLO_D       0x00000004
+#define ENTRYLO_V       0x00000002
+#define ENTRYLO_G       0x00000001
+#define PAGEMASK_MASK   0x01FFE000
+
+#define EXC_INT   0
+#define EXC_MOD   1
+#define EXC_TLBL  2
+#define EXC_TLBS  3
+#define EXC_ADEL  4
+#define EXC_ADES  5
+#define EXC_SYS   8
+#define EXC_RI    10
+#define EXC_CPU   11
+#define EXC_FPE   15
+
+#define EXC_VECTOR_REFILL  0x80000000
+#define EXC_VECTOR_GENERAL 0x80000180
+
+#define TLB_ENTRIES 48
+
+typedef struct {
+	uint32_t pagemask, entryhi, entrylo0, entrylo1;
+} tlb_entry_t;
+
+extern __thread uint32_t CP0[CP0_REGS];
+extern __thread tlb_entry_t TLB[TLB_ENTRIES];
+extern __thread uint32_t RANDOM_BASE; /* INSTRUCTION_COUNT when Random was last reset; Random is derived from it */
+extern __thread uint32_t COUNT_BIAS;  /* Count is (INSTRUCTION_COUNT >> 1) - COUNT_BIAS: it ticks every other cycle */
+
+/* cycle() takes its slow path only once INSTRUCTION_COUNT reaches NEXT_EVENT */
+extern __thread uint64_t NEXT_EVENT;  /* earliest of TIMER_EVENT, the next journal checkpoint and TELEMETRY_NEXT */
+extern __thread uint64_t TIMER_EVENT; /* the next Count == Compare, or now while an interrupt is deliverable */
+extern __thread uint64_t TIMER_MATCH; /* cycle of the next Count == Compare */
+
+/* an exception raised while executing the current instruction */
+extern __thread int EXCEPTION_PENDING;
+extern __thread uint32_t EXCEPTION_VECTOR;
+
+#define MMU_OFF   0 /* virtual == physical, as the lab layout assumes */
+#define MMU_SOFT  1 /* TLB translation; the simulator services refills with identity PTEs */
+#define MMU_GUEST 2 /* TLB translation; refills trap to the guest handler at 0x80000000 */
+extern int MMU_MODE;
+
+typedef struct {
+	uint64_t utlb_misses;   /* host micro-TLB misses (slow path taken) */
+	uint64_t tlb_lookups;
+	uint64_t tlb_misses;    /* no matching TLB entry */
+	uint64_t refills;       /* misses serviced by the simulator in MMU_SOFT */
+	uint64_t invalid, modified, address_errors;
+	uint64_t exceptions;
+} mmu_stats_t;
+
+extern __thread mmu_stats_t MMU_STATS;
+
+/* host-side micro-TLB: direct mapped, 4 KB virtual pages to host pointers */
+#define UTLB_SIZE 64
+typedef struct {
+	uint64_t tag;  /* UTLB_GEN | virtual page address; a stale generation never matches */
+	uint8_t *host; /* host address of the start of the page */
+} utlb_entry_t;
+
+extern __thread utlb_entry_t UTLB_READ[UTLB_SIZE], UTLB_WRITE[UTLB_SIZE];
+extern __thread uint64_t UTLB_GEN; /* generation in the upper 32 bits; bumped to flush */
+
+/***************************************************************/
+/* Coprocessor 1: MIPS I/II single and double floating point                             */
+/***************************************************************/
+#define FPU_REGS 32
+
+#define FMT_S 0x10
+#define FMT_D 0x11
+#define FMT_W 0x14
+
+/* the Flags, Enables and Cause fields hold the same FPE_* bits at different shifts */
+#define FCSR_RM        0x00000003
+#define FCSR_FLAGS     0x0000007C
+#define FCSR_ENABLES   0x00000F80
+#define FCSR_CAUSE     0x0003F000
+#define FCSR_C         0x00800000
+#define FCSR_FS        0x01000000 /* accepted, denormals are never flushed */
+#define FCSR_WRITABLE  (FCSR_RM | FCSR_FLAGS | FCSR_ENABLES | FCSR_CAUSE | FCSR_C | FCSR_FS)
+#define FCSR_FLAGS_SHIFT   2
+#define FCSR_ENABLES_SHIFT 7
+#define FCSR_CAUSE_SHIFT   12
+
+#define FPE_I 0x01 /* inexact */
+#define FPE_U 0x02 /* underflow */
+#define FPE_O 0x04 /* overflow */
+#define FPE_Z 0x08 /* divide by zero */
+#define FPE_V 0x10 /* invalid */
+#define FPE_E 0x20 /* unimplemented operation: Cause only, always enabled */
+
+#define FIR_R4400 0x00000500 /* FCR0: R4000-class FPU */
+
+/* MIPS I/II NaNs are the reverse of the host's: the top fraction bit set means signalling */
+#define FPU_NAN_S 0x7FBFFFFF
+#define FPU_NAN_D 0x7FF7FFFFFFFFFFFFULL
+
+extern __thread uint32_t FPR[FPU_REGS]; /* a double lives in an even/odd pair, low word in the even register */
+extern __thread uint32_t FCSR;          /* Flags may lag behind the host's sticky flags until fpu_sync() */
+extern int FPU_STRICT;                  /* take the strict path even when FCSR doesn't need it */
+
+typedef struct {
+	uint64_t fast, strict; /* arithmetic instructions on each path */
+	uint64_t traps;        /* FP exceptions taken */
+} fpu_stats_t;
+
+extern __thread fpu_stats_t FPU_STATS;
+
+/***************************************************************/
+/* Memory faults (recorded, acted on by the fuzzer)                                              */
+/***************************************************************/
+#define FAULT_NONE      0
+#define FAULT_UNMAPPED  1 /* access outside every memory region */
+#define FAULT_UNALIGNED 2 /* LW/SW/LH/SH on a misaligned address; the access is not made */
+#define FAULT_ILLEGAL   3 /* instruction not implemented */
+#define FAULT_EXCEPTION 4 /* exception with no handler at its vector */
+
+extern __thread int FAULT_FLAG;
+extern __thread uint32_t FAULT_ADDR;
+
+/***************************************************************/
+/* Dirty page tracking                                                                                       */
+/***************************************************************/
+#define MEM_PAGE_SHIFT 12
+#define MEM_PAGE_SIZE  (1 << MEM_PAGE_SHIFT)
+#define MEM_PAGE_ID(region, page) (((region) << 20) | (page))
+
+/* pages written since the last reset; every other page is known to be zero */
+extern __thread uint32_t *DIRTY_PAGES;
+extern __thread uint32_t DIRTY_COUNT, DIRTY_CAPACITY;
+
+typedef struct {
+	uint32_t count;
+	uint32_t *pages;  /* MEM_PAGE_ID of each saved page */
+	uint8_t *data;    /* count * MEM_PAGE_SIZE bytes */
+} mem_snapshot_t;
+
+/***************************************************************/
+/* Coverage-guided fuzzing                                                                                */
+/***************************************************************/
+#define FUZZ_MAP_SIZE      (1 << 14) /* edge coverage map, bytes */
+#define FUZZ_MAX_INPUT     1024
+#define FUZZ_MAX_CORPUS    4096
+#define FUZZ_MAX_WORKERS   64
+#define FUZZ_MAX_ARTIFACTS 256
+#define FUZZ_EXEC_LIMIT    100000 /* instructions before an exec is a timeout */
+#define FUZZ_TARGET_EXECS  20000  /* execs/s per worker the fuzzer is meant to sustain: tens of thousands */
+#define FUZZ_INPUT_ADDR    MEM_DATA_BEGIN
+#define FUZZ_IN_DIR        "fuzz-in"
+#define FUZZ_OUT_DIR       "fuzz-out"
+
+#define FUZZ_OK      0
+#define FUZZ_CRASH   1
+#define FUZZ_TIMEOUT 2
+
+extern __thread uint8_t *COVERAGE_MAP; /* NULL unless this thread is fuzzing */
+
+typedef struct {
+	uint32_t len;
+	uint8_t data[FUZZ_MAX_INPUT];
+} fuzz_input_t;
 
-char prog_file[32];
+typedef struct {
+	pthread_mutex_t lock;
+	fuzz_input_t *corpus;              /* entries are immutable once published */
+	uint32_t corpus_size;
+	uint8_t virgin[FUZZ_MAP_SIZE];     /* hit-count buckets seen so far */
+	uint32_t edges;
+	uint64_t artifacts[FUZZ_MAX_ARTIFACTS]; /* (kind, pc) of saved crashes */
+	uint32_t num_artifacts, crashes, timeouts;
+	int stop;
+} fuzz_state_t;
 
+typedef struct {
+	pthread_t thread;
+	uint64_t seed;
+	uint64_t execs;
+} fuzz_worker_t;
+
+extern fuzz_state_t FUZZ;
+
+/***************************************************************/
+/* Host performance counters (perf_event_open)                                                      */
+/***************************************************************/
+#define PERF_CYCLES        0
+#define PERF_INSTRUCTIONS  1
+#define PERF_BRANCH_MISSES 2
+#define PERF_L1D_MISSES    3
+#define PERF_LLC_MISSES    4
+#define PERF_TASK_CLOCK    5 /* ns on-CPU; wall time minus this is time blocked (I/O) */
+#define PERF_NUM_COUNTERS  6
+
+typedef struct {
+	int opened;                       /* counters have been opened once */
+	int fd[PERF_NUM_COUNTERS];        /* -1 when the host can't provide the counter */
+	int error[PERF_NUM_COUNTERS];     /* errno from perf_event_open */
+	uint64_t value[PERF_NUM_COUNTERS]; /* last run, scaled for multiplexing */
+	uint64_t sim_instructions;        /* instructions the last run simulated one by one */
+	uint64_t elided;                  /* and those loop fast-forward skipped */
+	uint64_t wall_ns;
+	struct timespec start;
+	uint64_t start_count, start_elided;
+	int valid;                        /* a run has been measured */
+} perf_stats_t;
+
+extern perf_stats_t PERF_STATS;
+extern int PERF_SUMMARY; /* print the report after every run/sim */
+
+/***************************************************************/
+/* Live telemetry (published by a sampling thread)                                                */
+/***************************************************************/
+#define TELEMETRY_SOCKET      1
+#define TELEMETRY_FILE        2
+#define TELEMETRY_SAMPLE_US   1000      /* PC sampling period */
+#define TELEMETRY_BLOCK_SHIFT 6         /* hot blocks are aligned 16-instruction windows */
+#define TELEMETRY_HOT_SIZE    4096      /* sampled blocks tracked (open addressing) */
+#define TELEMETRY_HOT_TOP     5
+#define TELEMETRY_MAX_CLIENTS 8
+#define TELEMETRY_FILE_MAX    (1 << 20) /* rotate the file to <path>.1 past this size */
+#define TELEMETRY_LINE_MAX    512
+#define TELEMETRY_SNAPSHOT    4099      /* instructions between snapshots (prime, so loops don't alias) */
+
+typedef struct {
+	uint32_t block;    /* PC >> TELEMETRY_BLOCK_SHIFT */
+	uint32_t samples;  /* halved every publish so the list follows phase changes */
+} telemetry_hot_t;
+
+typedef struct {
+	pthread_t thread;
+	int running;                     /* cleared (atomically) to stop the thread */
+	int mode;
+	char path[256];
+	uint32_t period_ms;
+
+	/* snapshot of the simulating thread, written and read with relaxed atomics */
+	uint64_t instructions;
+	uint32_t pc, dirty;
+	int run_flag;
+
+	int listen_fd, clients[TELEMETRY_MAX_CLIENTS], num_clients;
+	FILE *file;
+	telemetry_hot_t hot[TELEMETRY_HOT_SIZE], decay[TELEMETRY_HOT_SIZE];
+	int reopen_failed;
+	uint32_t window_samples;
+	uint64_t instructions_total, published;
+} telemetry_t;
+
+extern telemetry_t TELEMETRY;
+
+/* the thread that started telemetry snapshots itself once INSTRUCTION_COUNT reaches this */
+extern __thread uint64_t TELEMETRY_NEXT;
+
+/***************************************************************/
+/* Out-of-order superscalar timing model                                                               */
+/***************************************************************/
+#define OOO_CLASS_ALU    0
+#define OOO_CLASS_BRANCH 1
+#define OOO_CLASS_MULT   2
+#define OOO_CLASS_DIV    3 /* not pipelined */
+#define OOO_CLASS_LOAD   4
+#define OOO_CLASS_STORE  5
+#define OOO_CLASS_FPU    6 /* FP DIV/SQRT go to the divider */
+#define OOO_NUM_CLASSES  7
+
+#define OOO_MAX_WIDTH  16
+#define OOO_MAX_ROB    1024
+#define OOO_MAX_RS     256
+#define OOO_MAX_LSQ    256
+#define OOO_MAX_PRF    1024
+#define OOO_MAX_UNITS  8
+#define OOO_WINDOW     4096 /* cycles of issue-slot bookkeeping */
+#define OOO_STORE_SETS 1024 /* recent stores tracked for load forwarding */
+#define OOO_BPRED_SIZE 4096
+#define OOO_ARCH_REGS  (MIPS_REGS + 3 + FPU_REGS) /* GPRs, HI, LO, FPRs, FP condition */
+#define OOO_REG_HI     MIPS_REGS
+#define OOO_REG_LO     (MIPS_REGS + 1)
+#define OOO_REG_FPR(n) (MIPS_REGS + 2 + (n))
+#define OOO_REG_FCC    (MIPS_REGS + 2 + FPU_REGS)
+
+/* what held up dispatch */
+#define OOO_STALL_ROB   0
+#define OOO_STALL_RS    1
+#define OOO_STALL_LSQ   2
+#define OOO_STALL_PRF   3
+#define OOO_NUM_STALLS  4
+
+/* what each commit was waiting on; data dependences are split by producer class */
+#define OOO_CRIT_COMMIT     0
+#define OOO_CRIT_FETCH      1
+#define OOO_CRIT_MISPREDICT 2
+#define OOO_CRIT_DISPATCH   3
+#define OOO_CRIT_STRUCTURAL 4 /* ROB/RS/LSQ/PRF full */
+#define OOO_CRIT_ISSUE      5 /* issue width or functional unit contention */
+#define OOO_CRIT_DEP        6 /* + OOO_CLASS_* of the producer */
+#define OOO_NUM_CRIT        (OOO_CRIT_DEP + OOO_NUM_CLASSES)
+
+typedef struct {
+	uint32_t fetch_width, dispatch_width, issue_width, commit_width;
+	uint32_t rob_size, rs_size, lsq_size, phys_regs;
+	uint32_t frontend_depth; /* fetch to dispatch, also the refetch cost after a mispredict */
+	uint32_t units[OOO_NUM_CLASSES];
+	uint32_t latency[OOO_NUM_CLASSES];
+} ooo_config_t;
+
+typedef struct {
+	int cls;
+	uint32_t num_srcs, num_dests;
+	uint32_t srcs[4], dests[2];
+	int is_branch, is_cond_branch, is_indirect;
+} ooo_inst_t;
+
+typedef struct {
+	uint64_t instructions;
+	uint64_t fetch_cycle, dispatch_cycle, commit_cycle, redirect_cycle;
+	uint32_t fetch_count, dispatch_count, commit_count;
+
+	uint64_t rob_commit[OOO_MAX_ROB];  /* commit cycle of the instruction in each ROB slot */
+	uint64_t lsq_commit[OOO_MAX_LSQ];
+	uint64_t prf_commit[OOO_MAX_PRF];  /* commit cycle of each renaming instruction (frees the old mapping) */
+	uint64_t num_mem, num_renamed;
+	uint64_t rs_issue[OOO_MAX_RS];     /* issue cycles of instructions waiting in the reservation stations */
+	uint32_t rs_count;
+
+	uint64_t reg_ready[OOO_ARCH_REGS]; /* cycle the latest rename of each register is produced */
+	uint8_t reg_class[OOO_ARCH_REGS];
+
+	uint64_t slot_tag[OOO_WINDOW];
+	uint8_t slot_issued[OOO_WINDOW];
+	uint8_t slot_units[OOO_WINDOW][OOO_NUM_CLASSES];
+	uint64_t div_busy[OOO_MAX_UNITS];
+
+	uint32_t store_addr[OOO_STORE_SETS];
+	uint64_t store_ready[OOO_STORE_SETS];
+
+	uint8_t bimodal[OOO_BPRED_SIZE];
+	uint32_t indirect_target[OOO_BPRED_SIZE];
+
+	uint64_t class_count[OOO_NUM_CLASSES];
+	uint64_t branches, mispredicts;
+	uint64_t stall[OOO_NUM_STALLS];
+	uint64_t critical[OOO_NUM_CRIT];
+} ooo_model_t;
+
+extern ooo_config_t OOO_CONFIG;
+extern __thread ooo_model_t *OOO_MODEL; /* NULL when the timing model is off */
+
+/* model counters sampled once per loop iteration by fast-forward (see ooo_vector) */
+#define OOO_V_FETCH          0
+#define OOO_V_DISPATCH       1
+#define OOO_V_COMMIT         2
+#define OOO_V_INSTRUCTIONS   3
+#define OOO_V_MEM            4
+#define OOO_V_RENAMED        5
+#define OOO_V_BRANCHES       6
+#define OOO_V_MISPREDICTS    7
+#define OOO_V_FETCH_COUNT    8  /* these four must repeat exactly, not just advance */
+#define OOO_V_DISPATCH_COUNT 9
+#define OOO_V_COMMIT_COUNT   10
+#define OOO_V_RS_COUNT       11
+#define OOO_V_CLASS          12
+#define OOO_V_STALL          (OOO_V_CLASS + OOO_NUM_CLASSES)
+#define OOO_V_CRIT           (OOO_V_STALL + OOO_NUM_STALLS)
+#define OOO_NUM_VECTOR       (OOO_V_CRIT + OOO_NUM_CRIT)
+
+/***************************************************************/
+/* Reverse execution: undo journal and checkpoints                                                 */
+/***************************************************************/
+#define JOURNAL_DEFAULT_BYTES       (64 << 20)
+#define JOURNAL_MIN_BYTES           (1 << 20)
+#define JOURNAL_MAX_CHECKPOINTS     32
+#define JOURNAL_CHECKPOINT_INTERVAL 100000 /* instructions, doubles each time checkpoints are thinned */
+
+typedef struct {
+	uint8_t *loc;  /* host address of the overwritten word; NULL marks the start of a step */
+	uint64_t old;  /* previous word (the step's PC for a marker, the extra instructions for a skip) */
+} journal_record_t;
+
+typedef struct {
+	CPU_State state;
+	uint32_t cp0[CP0_REGS];
+	tlb_entry_t tlb[TLB_ENTRIES];
+	uint32_t random_base, count_bias;
+	uint32_t fpr[FPU_REGS], fcsr;
+	uint64_t instruction_count;
+	int run_flag;
+	mem_snapshot_t memory;
+} checkpoint_t;
+
+typedef struct {
+	uint64_t budget;                   /* bytes for records plus checkpoints */
+	journal_record_t *records;         /* ring, newest record at head - 1 */
+	uint32_t capacity, head, count;
+	uint64_t steps;                    /* instructions that can be undone from the ring */
+	checkpoint_t checkpoints[JOURNAL_MAX_CHECKPOINTS]; /* oldest first */
+	uint32_t num_checkpoints;
+	uint32_t checkpoint_interval;
+	uint64_t next_checkpoint;
+	uint64_t checkpoint_bytes;
+} journal_t;
+
+extern __thread journal_t *JOURNAL; /* NULL on threads that can't run backwards */
+
+/* record in a fast-forwarded step: <old> is the number of instructions beyond the first */
+#define JOURNAL_SKIP ((uint8_t *)1)
+
+#define MAX_BREAKPOINTS 16
+extern uint32_t BREAKPOINTS[MAX_BREAKPOINTS];
+extern int NUM_BREAKPOINTS;
+
+
+/***************************************************************/
+/* Loop fast-forward                                                                                        */
+/***************************************************************/
+#define FF_MAX_BODY    16 /* longest loop body (instructions) that is analysed */
+#define FF_REJECT_SIZE 64 /* direct-mapped cache of loops known not to qualify */
+#define FF_INFINITE    UINT64_MAX
+#define FF_UNLIMITED   UINT32_MAX /* budget for runs with no instruction limit */
+
+typedef struct {
+	uint32_t branch, head;
+} ff_loop_t;
+
+typedef struct {
+	ff_loop_t reject[FF_REJECT_SIZE];
+
+	/* per-iteration timing-model deltas of the loop being watched */
+	ff_loop_t loop;
+	uint64_t last[OOO_NUM_VECTOR], delta[OOO_NUM_VECTOR];
+	uint32_t steady;           /* consecutive iterations with identical deltas */
+
+	uint64_t skips, spins;     /* loops fast-forwarded, never-ending loops stopped */
+	uint64_t elided, timed;    /* instructions skipped, of which extrapolated on the timing model */
+} ff_state_t;
+
+extern __thread ff_state_t FF;
+extern int FF_FLAG;
+
+/***************************************************************/
+/* Parallel interval simulation from checkpoints                                                    */
+/***************************************************************/
+#define INTERVAL_MAX_WORKERS     64
+#define INTERVAL_MAX_CHECKPOINTS 4096
+#define INTERVAL_MAX_BYTES       (512ULL << 20) /* checkpoint memory pages; over this, intervals double */
+
+typedef struct {
+	uint64_t instructions, cycles;
+	uint64_t elapsed_ns;   /* worker CPU time to re-simulate the interval */
+	int verified;          /* end state matched the next checkpoint */
+} interval_result_t;
+
+typedef struct {
+	checkpoint_t *checkpoints;  /* checkpoints[i] starts interval i; the last one is the final state */
+	uint32_t num_checkpoints;
+	uint32_t next;              /* next interval to claim */
+	interval_result_t *results;
+} interval_state_t;
+
+typedef struct {
+	pthread_t thread;
+	ooo_model_t *total;         /* timing statistics summed over this worker's intervals */
+	mmu_stats_t mmu;
+	uint32_t intervals;
+} interval_worker_t;
+
+extern interval_state_t INTERVALS;
+
+/***************************************************************/
+/* Static WCET analysis of the loaded text                                                           */
+/***************************************************************/
+#define WCET_MAX_BOUNDS  64
+#define WCET_MAX_LISTED  64         /* blocks printed in the report */
+#define WCET_UNBOUNDED   UINT64_MAX
+#define WCET_NONE        -1
+
+/* control-flow kind of an instruction */
+#define WCET_SEQ     0
+#define WCET_BRANCH  1
+#define WCET_JUMP    2
+#define WCET_CALL    3
+#define WCET_RETURN  4
+#define WCET_ICALL   5 /* JALR: callee unknown */
+#define WCET_SYSCALL 6
+#define WCET_IJUMP   7 /* JR through anything but $ra (e.g. a jump table): target unknown */
+
+#define WCET_IN_TEXT(w, addr) ((addr) >= MEM_TEXT_BEGIN && (addr) < MEM_TEXT_BEGIN + 4 * (w)->num_insts && ((addr) & 3) == 0)
+
+typedef struct {
+	uint32_t header;   /* address of the loop's first instruction */
+	uint32_t bound;    /* maximum iterations */
+} wcet_bound_t;
+
+extern wcet_bound_t WCET_BOUNDS[WCET_MAX_BOUNDS];
+extern int WCET_NUM_BOUNDS;
+extern uint32_t WCET_LATENCY[OOO_NUM_CLASSES]; /* in-order cycles per OOO_CLASS_* */
+
+typedef struct {
+	uint32_t start, end;  /* first and last instruction */
+	int succ[2], num_succ;
+	int callee;           /* function called by a trailing JAL */
+	int function;         /* function owning the block */
+	uint64_t cost;        /* sum of instruction latencies */
+	uint64_t node_cost;   /* cost plus callee; for a collapsed loop header, the whole loop */
+	int rep;              /* header of the outermost collapsed loop containing the block */
+	int next_member;      /* next block of the loop collapsed into this one */
+	int loop;             /* loop headed by this block */
+} wcet_block_t;
+
+typedef struct {
+	int header;
+	uint8_t *body;        /* body[block] */
+	int size;
+	uint32_t bound;       /* 0 when not annotated */
+	uint64_t iteration, total;
+	int *path, path_len;  /* worst iteration */
+} wcet_loop_t;
+
+typedef struct {
+	int entry;
+	int state;            /* 0 unvisited, 1 in progress, 2 done */
+	uint64_t wcet;
+	int *path, path_len;
+} wcet_function_t;
+
+typedef struct {
+	uint32_t num_insts;
+	wcet_block_t *blocks;
+	int num_blocks;
+	int *block_of;        /* block_of[instruction index] */
+	wcet_loop_t *loops;
+	int num_loops;
+	wcet_function_t *functions;
+	int num_functions;
+	int recursive, indirect, escapes;
+
+	/* longest-path scratch */
+	uint64_t *dist;
+	int *next, *mark;
+	int *order, *stack;       /* DFS post-order and stack of representatives */
+	int *cur_block, *cur_succ; /* per representative: where its successor walk is */
+	uint8_t *in_region;
+} wcet_t;
 
 /***************************************************************/
 /* Function Declerations.                                                                                                */
 /***************************************************************/
+/* mu-mips.c */
 void help();
 uint32_t mem_read_32(uint32_t address);
 void mem_write_32(uint32_t address, uint32_t value);
@@ -78,3 +674,119 @@ void handle_instruction(); /*IMPLEMENT THIS*/
 void initialize();
 void print_program(); /*IMPLEMENT THIS*/
 void print_instruction(uint32_t);
+void mem_mark_dirty(int region, uint32_t offset);
+void clear_memory();
+void mem_snapshot_take(mem_snapshot_t *snap);
+void mem_snapshot_restore(const mem_snapshot_t *snap);
+void mem_snapshot_free(mem_snapshot_t *snap);
+void free_memory();
+uint8_t *mem_host_page(uint32_t physical);
+int mem_page_written(uint32_t physical);
+int mem_snapshot_matches(const mem_snapshot_t *snap);
+
+/* mmu.c */
+void cp0_reset();
+uint32_t cp0_read(int reg);
+void cp0_set(int reg, uint32_t value);
+void cp0_write(int reg, uint32_t value);
+void raise_exception(int code, uint32_t badvaddr, int refill);
+void timer_schedule();
+void timer_event();
+int interrupts_enabled();
+void event_schedule();
+void event_dispatch();
+uint32_t counters_read(uint32_t address);
+void tlb_write(int index);
+int tlb_translate(uint32_t address, int write, uint32_t *physical);
+void utlb_flush();
+uint32_t vmem_read_slow(uint32_t address);
+void vmem_write_slow(uint32_t address, uint32_t value);
+uint32_t vmem_peek_32(uint32_t address);
+int handle_cop0(uint32_t instruction);
+void mmu_command();
+void mmu_report();
+
+/* fpu.c */
+void fpu_reset();
+void fpu_sync();
+int fpu_usable();
+void fpu_arith(uint32_t instruction);
+int handle_cop1(uint32_t instruction);
+void fpu_report();
+void fpu_command();
+
+/* perf.c */
+void perf_open();
+void perf_begin();
+void perf_end();
+void perf_report();
+
+/* telemetry.c */
+void telemetry_snapshot();
+void telemetry_sample(uint32_t pc);
+int telemetry_format(char *line, size_t size, double elapsed, double mips, uint32_t pc);
+void telemetry_publish(const char *line, int len);
+void *telemetry_main(void *arg);
+void telemetry_start(int mode, const char *path, uint32_t period_ms);
+void telemetry_stop();
+void telemetry_command();
+
+/* journal.c */
+void journal_init(uint64_t budget);
+void journal_free();
+void journal_command();
+void journal_clear();
+void journal_push(uint8_t *loc, uint64_t old);
+void journal_record(uint8_t *loc);
+void journal_begin_step();
+int journal_undo_step();
+void journal_checkpoint();
+void journal_drop_checkpoint();
+void journal_restore(uint32_t index);
+uint32_t journal_replay_step(uint64_t target);
+void journal_seek(uint64_t target);
+void checkpoint_take(checkpoint_t *ck);
+void checkpoint_restore(const checkpoint_t *ck);
+int checkpoint_matches(const checkpoint_t *ck);
+void reverse_report();
+void rstep(uint32_t n);
+void rcontinue();
+int is_breakpoint(uint32_t addr);
+void toggle_breakpoint(uint32_t addr);
+
+/* ff.c */
+int fast_forward(uint32_t branch_pc, uint32_t budget, uint32_t *elided);
+uint64_t ff_trips(uint32_t instruction, const uint32_t *delta);
+uint64_t ff_signed_trips(int64_t value, int64_t delta, int64_t lo, int64_t hi);
+void ff_report();
+
+/* ooo.c */
+void ooo_decode(uint32_t instruction, ooo_inst_t *inst);
+void ooo_reset();
+void ooo_instruction(uint32_t pc, uint32_t next_pc);
+void ooo_report(const ooo_model_t *m);
+void ooo_command();
+void ooo_merge(ooo_model_t *total, const ooo_model_t *part);
+void ooo_vector(uint64_t *v);
+void ooo_rotate(void *ring, size_t elem, uint32_t size, uint32_t by);
+void ooo_advance(uint64_t iterations, const uint64_t *delta);
+
+/* wcet.c */
+uint64_t wcet_add(uint64_t a, uint64_t b);
+uint64_t wcet_mul(uint64_t a, uint64_t b);
+int wcet_decode(uint32_t addr, uint32_t instruction, uint32_t *target);
+void wcet_build(wcet_t *w);
+int wcet_next_succ(wcet_t *w, int n, int header);
+uint64_t wcet_longest(wcet_t *w, int start, int header, int **path, int *path_len);
+uint64_t wcet_function(wcet_t *w, int f);
+void wcet_print_cycles(uint64_t cycles);
+void wcet_print_path(wcet_t *w, const int *path, int path_len, int header);
+void wcet_report();
+void wcet_command();
+
+/* fuzz.c */
+void fuzz(int seconds, int num_workers);
+
+/* interval.c */
+void *interval_worker(void *arg);
+void interval_run(uint32_t length, int num_workers);
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/***************************************************************/
+/* Live view of the records MU-MIPS publishes with                                         */
+/*     telemetry socket <path> <ms>   or   telemetry file <path> <ms>                  */
+/* Usage: mu-telemetry <path>                                                                          */
+/***************************************************************/
+
+#define LINE_MAX_LEN 512
+#define FILE_POLL_US 250000
+
+/***************************************************************/
+/* Value of <key> in a record of key=value pairs, or "?"                              */
+/***************************************************************/
+const char *field(char *line, const char *key, char *value, size_t size) {
+	char *p = line;
+	size_t n = strlen(key);
+
+	while ((p = strstr(p, key)) != NULL) {
+		if ((p == line || p[-1] == ' ') && p[n] == '=') {
+			p += n + 1;
+			n = strcspn(p, " \n");
+			if (n >= size) n = size - 1;
+			memcpy(value, p, n);
+			value[n] = '\0';
+			return value;
+		}
+		p += n;
+	}
+	return "?";
+}
+
+/***************************************************************/
+/* Redraw the screen from one record                                                          */
+/***************************************************************/
+void show(char *line, const char *path) {
+	char value[LINE_MAX_LEN], hot[LINE_MAX_LEN], *block;
+
+	printf("\033[H\033[J");
+	printf("-------------------------------------------------------------\n");
+	printf("MU-MIPS telemetry from %s (record %s)\n", path, field(line, "seq", value, sizeof(value)));
+	printf("-------------------------------------------------------------\n");
+	printf("elapsed (s)\t\t: %s\n", field(line, "t", value, sizeof(value)));
+	printf("guest instructions\t: %s\n", field(line, "insts", value, sizeof(value)));
+	printf("host MIPS\t\t: %s\n", field(line, "mips", value, sizeof(value)));
+	printf("PC\t\t\t: %s\n", field(line, "pc", value, sizeof(value)));
+	printf("running\t\t\t: %s\n", strcmp(field(line, "running", value, sizeof(value)), "1") == 0 ? "yes" : "no");
+	printf("pages written\t\t: %s\n", field(line, "dirty", value, sizeof(value)));
+	printf("-------------------------------------------------------------\n");
+	printf("[Hot block]\t\t[Share of samples]\n");
+	field(line, "hot", hot, sizeof(hot));
+	for (block = strtok(hot, ","); block != NULL; block = strtok(NULL, ",")) {
+		if (strcmp(block, "-") == 0) break;
+		block[strcspn(block, ":")] = '\t';
+		printf("%s\n", block);
+	}
+	printf("-------------------------------------------------------------\n");
+	fflush(stdout);
+}
+
+/***************************************************************/
+/* Follow a socket: one record per line                                                          */
+/***************************************************************/
+int follow_socket(const char *path) {
+	struct sockaddr_un addr;
+	char buffer[LINE_MAX_LEN * 4], *end;
+	size_t used = 0;
+	ssize_t n;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		printf("Error: can't connect to %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	while ((n = read(fd, buffer + used, sizeof(buffer) - used - 1)) > 0) {
+		used += n;
+		buffer[used] = '\0';
+		/* only the newest complete record is worth drawing */
+		while ((end = strchr(buffer, '\n')) != NULL && strchr(end + 1, '\n') != NULL) {
+			used -= end + 1 - buffer;
+			memmove(buffer, end + 1, used + 1);
+		}
+		if ((end = strchr(buffer, '\n')) != NULL) {
+			*end = '\0';
+			show(buffer, path);
+			used -= end + 1 - buffer;
+			memmove(buffer, end + 1, used + 1);
+		}
+		if (used == sizeof(buffer) - 1) {
+			used = 0;
+		}
+	}
+	printf("Simulator closed the connection.\n");
+	close(fd);
+	return 0;
+}
+
+/***************************************************************/
+/* Follow a file: redraw whenever its last record changes                        */
+/***************************************************************/
+int follow_file(const char *path) {
+	char line[LINE_MAX_LEN], newest[LINE_MAX_LEN], shown[LINE_MAX_LEN] = "";
+	long size;
+	FILE *f;
+
+	while (1) {
+		f = fopen(path, "r");
+		if (f != NULL) {
+			/* the last record is within the final LINE_MAX_LEN bytes */
+			fseek(f, 0, SEEK_END);
+			size = ftell(f);
+			fseek(f, size > 2 * LINE_MAX_LEN ? size - 2 * LINE_MAX_LEN : 0, SEEK_SET);
+			newest[0] = '\0';
+			while (fgets(line, sizeof(line), f) != NULL) {
+				if (strncmp(line, "seq=", 4) == 0 && strchr(line, '\n') != NULL) {
+					strcpy(newest, line);
+				}
+			}
+			fclose(f);
+			if (newest[0] && strcmp(newest, shown) != 0) {
+				strcpy(shown, newest);
+				show(newest, path);
+			}
+		}
+		usleep(FILE_POLL_US);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	struct stat st;
+
+	if (argc < 2) {
+		printf("Usage: %s <telemetry socket or file>\n", argv[0]);
+		return 1;
+	}
+	if (stat(argv[1], &st) != 0) {
+		printf("Error: %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	return S_ISSOCK(st.st_mode) ? follow_socket(argv[1]) : follow_file(argv[1]);
+}
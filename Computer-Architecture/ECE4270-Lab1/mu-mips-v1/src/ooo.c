@@ -0,0 +1,657 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <strings.h>
+
+#include "mu-mips.h"
+
+ooo_config_t OOO_CONFIG = {
+	4, 4, 4, 4,         /* fetch, dispatch, issue, commit width */
+	128, 48, 32, 160,   /* ROB, RS, LSQ, physical registers */
+	4,                  /* front-end depth */
+	{ 3, 1, 1, 1, 2, 1, 1 }, /* units: ALU, branch, mult, div, load, store, FPU */
+	{ 1, 1, 4, 35, 3, 1, 4 } /* latency: ALU, branch, mult, div, load, store, FPU */
+};
+__thread ooo_model_t *OOO_MODEL;
+
+/************************************************************/
+/* Register operands and unit class of an instruction for the timing model        */
+/************************************************************/
+void ooo_decode(uint32_t instruction, ooo_inst_t *inst){
+	uint32_t opcode, function, rs, rt, rd, sa;
+
+	opcode = (instruction & 0xFC000000) >> 26;
+	function = instruction & 0x0000003F;
+	rs = (instruction & 0x03E00000) >> 21;
+	rt = (instruction & 0x001F0000) >> 16;
+	rd = (instruction & 0x0000F800) >> 11;
+	sa = (instruction & 0x000007C0) >> 6;
+
+	memset(inst, 0, sizeof(*inst));
+	inst->cls = OOO_CLASS_ALU;
+
+	if(opcode == 0x00){
+		switch(function){
+			case 0x00: //SLL
+			case 0x02: //SRL
+			case 0x03: //SRA
+				inst->srcs[inst->num_srcs++] = rt;
+				inst->dests[inst->num_dests++] = rd;
+				break;
+			case 0x08: //JR
+			case 0x09: //JALR
+				inst->cls = OOO_CLASS_BRANCH;
+				inst->is_branch = inst->is_indirect = TRUE;
+				inst->srcs[inst->num_srcs++] = rs;
+				if(function == 0x09){
+					inst->dests[inst->num_dests++] = rd;
+				}
+				break;
+			case 0x0C: //SYSCALL
+				inst->srcs[inst->num_srcs++] = 2;
+				break;
+			case 0x10: //MFHI
+				inst->srcs[inst->num_srcs++] = OOO_REG_HI;
+				inst->dests[inst->num_dests++] = rd;
+				break;
+			case 0x11: //MTHI
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->dests[inst->num_dests++] = OOO_REG_HI;
+				break;
+			case 0x12: //MFLO
+				inst->srcs[inst->num_srcs++] = OOO_REG_LO;
+				inst->dests[inst->num_dests++] = rd;
+				break;
+			case 0x13: //MTLO
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->dests[inst->num_dests++] = OOO_REG_LO;
+				break;
+			case 0x18: //MULT
+			case 0x19: //MULTU
+			case 0x1A: //DIV
+			case 0x1B: //DIVU
+				inst->cls = function < 0x1A ? OOO_CLASS_MULT : OOO_CLASS_DIV;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->srcs[inst->num_srcs++] = rt;
+				inst->dests[inst->num_dests++] = OOO_REG_HI;
+				inst->dests[inst->num_dests++] = OOO_REG_LO;
+				break;
+			default: //ADD, ADDU, SUB, SUBU, AND, OR, XOR, NOR, SLT
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->srcs[inst->num_srcs++] = rt;
+				inst->dests[inst->num_dests++] = rd;
+				break;
+		}
+	}
+	else{
+		switch(opcode){
+			case 0x01: //BLTZ, BGEZ
+			case 0x06: //BLEZ
+			case 0x07: //BGTZ
+				inst->cls = OOO_CLASS_BRANCH;
+				inst->is_branch = inst->is_cond_branch = TRUE;
+				inst->srcs[inst->num_srcs++] = rs;
+				break;
+			case 0x04: //BEQ
+			case 0x05: //BNE
+				inst->cls = OOO_CLASS_BRANCH;
+				inst->is_branch = inst->is_cond_branch = TRUE;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->srcs[inst->num_srcs++] = rt;
+				break;
+			case 0x02: //J
+			case 0x03: //JAL
+				inst->cls = OOO_CLASS_BRANCH;
+				inst->is_branch = TRUE;
+				if(opcode == 0x03){
+					inst->dests[inst->num_dests++] = 31;
+				}
+				break;
+			case 0x0F: //LUI
+				inst->dests[inst->num_dests++] = rt;
+				break;
+			case 0x10: //COP0
+				if(rs == 0x00){ //MFC0
+					inst->dests[inst->num_dests++] = rt;
+				}
+				else if(rs == 0x04){ //MTC0
+					inst->srcs[inst->num_srcs++] = rt;
+				}
+				else if(function == 0x18){ //ERET
+					inst->cls = OOO_CLASS_BRANCH;
+					inst->is_branch = inst->is_indirect = TRUE;
+				}
+				break;
+			case 0x11: //COP1; a double reads, and its result renames, both halves of the pair
+				if(rs == 0x00 || rs == 0x02){ //MFC1, CFC1
+					inst->srcs[inst->num_srcs++] = rs == 0x00 ? OOO_REG_FPR(rd) : OOO_REG_FCC;
+					inst->dests[inst->num_dests++] = rt;
+				}
+				else if(rs == 0x04 || rs == 0x06){ //MTC1, CTC1
+					inst->srcs[inst->num_srcs++] = rt;
+					inst->dests[inst->num_dests++] = rs == 0x04 ? OOO_REG_FPR(rd) : OOO_REG_FCC;
+				}
+				else if(rs == 0x08){ //BC1T, BC1F
+					inst->cls = OOO_CLASS_BRANCH;
+					inst->is_branch = inst->is_cond_branch = TRUE;
+					inst->srcs[inst->num_srcs++] = OOO_REG_FCC;
+				}
+				else{
+					inst->cls = function == 0x03 || function == 0x04 ? OOO_CLASS_DIV : OOO_CLASS_FPU;
+					inst->srcs[inst->num_srcs++] = OOO_REG_FPR(rd);
+					if(rs == FMT_D){
+						inst->srcs[inst->num_srcs++] = OOO_REG_FPR((rd + 1) & 0x1F);
+					}
+					if(function < 0x04 || function >= 0x30){
+						inst->srcs[inst->num_srcs++] = OOO_REG_FPR(rt);
+						if(rs == FMT_D){
+							inst->srcs[inst->num_srcs++] = OOO_REG_FPR((rt + 1) & 0x1F);
+						}
+					}
+					if(function >= 0x30){
+						inst->dests[inst->num_dests++] = OOO_REG_FCC;
+					}
+					else{
+						inst->dests[inst->num_dests++] = OOO_REG_FPR(sa);
+						if(function == 0x21 || (rs == FMT_D && function <= 0x07)){
+							inst->dests[inst->num_dests++] = OOO_REG_FPR((sa + 1) & 0x1F);
+						}
+					}
+				}
+				break;
+			case 0x20: //LB
+			case 0x21: //LH
+			case 0x23: //LW
+				inst->cls = OOO_CLASS_LOAD;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->dests[inst->num_dests++] = rt;
+				break;
+			case 0x28: //SB
+			case 0x29: //SH
+			case 0x2B: //SW
+				inst->cls = OOO_CLASS_STORE;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->srcs[inst->num_srcs++] = rt;
+				break;
+			case 0x31: //LWC1
+			case 0x35: //LDC1
+				inst->cls = OOO_CLASS_LOAD;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->dests[inst->num_dests++] = OOO_REG_FPR(rt);
+				if(opcode == 0x35){
+					inst->dests[inst->num_dests++] = OOO_REG_FPR((rt + 1) & 0x1F);
+				}
+				break;
+			case 0x39: //SWC1
+			case 0x3D: //SDC1
+				inst->cls = OOO_CLASS_STORE;
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->srcs[inst->num_srcs++] = OOO_REG_FPR(rt);
+				if(opcode == 0x3D){
+					inst->srcs[inst->num_srcs++] = OOO_REG_FPR((rt + 1) & 0x1F);
+				}
+				break;
+			default: //ADDI, ADDIU, SLTI, ANDI, ORI, XORI
+				inst->srcs[inst->num_srcs++] = rs;
+				inst->dests[inst->num_dests++] = rt;
+				break;
+		}
+	}
+}
+
+/************************************************************/
+/* Start the timing model from an empty pipeline                                                */
+/************************************************************/
+void ooo_reset(){
+	if(OOO_MODEL == NULL){
+		OOO_MODEL = malloc(sizeof(ooo_model_t));
+		assert(OOO_MODEL != NULL);
+	}
+	memset(OOO_MODEL, 0, sizeof(ooo_model_t));
+	memset(OOO_MODEL->bimodal, 2, sizeof(OOO_MODEL->bimodal)); /* weakly taken */
+}
+
+/************************************************************/
+/* Time one functionally executed instruction through the OoO pipeline             */
+/* (called from cycle() before CURRENT_STATE is overwritten)                                */
+/************************************************************/
+void ooo_instruction(uint32_t pc, uint32_t next_pc){
+	ooo_model_t *m = OOO_MODEL;
+	ooo_config_t *c = &OOO_CONFIG;
+	ooo_inst_t inst;
+	uint32_t instruction, addr, slot, set, free_regs;
+	uint64_t fetch, dispatch, in_order, ready, issue, complete, commit, oldest;
+	uint32_t i, j, unit;
+	int cause, stall, renames, is_mem, taken, predicted;
+
+	instruction = vmem_peek_32(pc);
+	ooo_decode(instruction, &inst);
+	m->class_count[inst.cls]++;
+	is_mem = inst.cls == OOO_CLASS_LOAD || inst.cls == OOO_CLASS_STORE;
+	renames = inst.num_dests > 0 && (inst.dests[0] != 0 || inst.num_dests > 1);
+
+	/* fetch: fetch_width per cycle, a taken branch ends the fetch group */
+	cause = OOO_CRIT_FETCH;
+	if(m->redirect_cycle > m->fetch_cycle){
+		m->fetch_cycle = m->redirect_cycle;
+		m->fetch_count = 0;
+		cause = OOO_CRIT_MISPREDICT;
+	}
+	if(m->fetch_count >= c->fetch_width){
+		m->fetch_cycle++;
+		m->fetch_count = 0;
+	}
+	fetch = m->fetch_cycle;
+	m->fetch_count++;
+	taken = next_pc != pc + 4;
+	if(inst.is_branch && taken){
+		m->fetch_count = c->fetch_width;
+	}
+
+	/* dispatch (rename): in order, waits for a free ROB/LSQ/RS entry and physical register */
+	dispatch = fetch + c->frontend_depth;
+	if(m->dispatch_cycle > dispatch){
+		dispatch = m->dispatch_cycle;
+		cause = OOO_CRIT_DISPATCH;
+	}
+	in_order = dispatch;
+	stall = -1;
+	if(m->instructions >= c->rob_size && m->rob_commit[m->instructions % c->rob_size] > dispatch){
+		dispatch = m->rob_commit[m->instructions % c->rob_size];
+		stall = OOO_STALL_ROB;
+	}
+	if(is_mem && m->num_mem >= c->lsq_size && m->lsq_commit[m->num_mem % c->lsq_size] > dispatch){
+		dispatch = m->lsq_commit[m->num_mem % c->lsq_size];
+		stall = OOO_STALL_LSQ;
+	}
+	free_regs = c->phys_regs - OOO_ARCH_REGS;
+	if(renames && m->num_renamed >= free_regs && m->prf_commit[m->num_renamed % free_regs] > dispatch){
+		dispatch = m->prf_commit[m->num_renamed % free_regs];
+		stall = OOO_STALL_PRF;
+	}
+	/* reservation station entries free up when their instruction issues */
+	for(i = 0; i < m->rs_count; ){
+		if(m->rs_issue[i] < dispatch){
+			m->rs_issue[i] = m->rs_issue[--m->rs_count];
+		}
+		else{
+			i++;
+		}
+	}
+	if(m->rs_count >= c->rs_size){
+		for(i = 1, j = 0; i < m->rs_count; i++){
+			if(m->rs_issue[i] < m->rs_issue[j]) j = i;
+		}
+		dispatch = m->rs_issue[j] + 1;
+		m->rs_issue[j] = m->rs_issue[--m->rs_count];
+		stall = OOO_STALL_RS;
+	}
+	if(stall >= 0){
+		m->stall[stall] += dispatch - in_order;
+		cause = OOO_CRIT_STRUCTURAL;
+	}
+	if(dispatch > m->dispatch_cycle){
+		m->dispatch_cycle = dispatch;
+		m->dispatch_count = 0;
+	}
+	else if(m->dispatch_count >= c->dispatch_width){
+		m->dispatch_cycle = ++dispatch;
+		m->dispatch_count = 0;
+		cause = OOO_CRIT_DISPATCH;
+	}
+	m->dispatch_count++;
+
+	/* issue: once operands are ready and an issue slot and unit are free */
+	ready = dispatch + 1;
+	for(i = 0; i < inst.num_srcs; i++){
+		if(inst.srcs[i] != 0 && m->reg_ready[inst.srcs[i]] > ready){
+			ready = m->reg_ready[inst.srcs[i]];
+			cause = OOO_CRIT_DEP + m->reg_class[inst.srcs[i]];
+		}
+	}
+	addr = set = 0;
+	if(is_mem){
+		addr = (CURRENT_STATE.REGS[(instruction >> 21) & 0x1F] + (int16_t)(instruction & 0xFFFF)) & ~0x3;
+		set = (addr >> 2) & (OOO_STORE_SETS - 1);
+		/* loads wait for an older store to the same word to forward its data */
+		if(inst.cls == OOO_CLASS_LOAD && m->store_addr[set] == addr && m->store_ready[set] > ready){
+			ready = m->store_ready[set];
+			cause = OOO_CRIT_DEP + OOO_CLASS_STORE;
+		}
+	}
+	issue = ready;
+	unit = 0;
+	if(inst.cls == OOO_CLASS_DIV){
+		for(i = 1; i < c->units[OOO_CLASS_DIV]; i++){
+			if(m->div_busy[i] < m->div_busy[unit]) unit = i;
+		}
+		if(m->div_busy[unit] > issue){
+			issue = m->div_busy[unit];
+		}
+	}
+	for(;; issue++){
+		slot = issue % OOO_WINDOW;
+		if(m->slot_tag[slot] != issue){
+			m->slot_tag[slot] = issue;
+			m->slot_issued[slot] = 0;
+			memset(m->slot_units[slot], 0, OOO_NUM_CLASSES);
+		}
+		if(m->slot_issued[slot] < c->issue_width && m->slot_units[slot][inst.cls] < c->units[inst.cls]){
+			break;
+		}
+	}
+	m->slot_issued[slot]++;
+	m->slot_units[slot][inst.cls]++;
+	if(issue > ready){
+		cause = OOO_CRIT_ISSUE;
+	}
+	if(inst.cls == OOO_CLASS_DIV){
+		m->div_busy[unit] = issue + c->latency[OOO_CLASS_DIV];
+	}
+	if(m->rs_count < OOO_MAX_RS){
+		m->rs_issue[m->rs_count++] = issue;
+	}
+
+	/* execute */
+	complete = issue + c->latency[inst.cls];
+	for(i = 0; i < inst.num_dests; i++){
+		if(inst.dests[i] != 0){
+			m->reg_ready[inst.dests[i]] = complete;
+			m->reg_class[inst.dests[i]] = inst.cls;
+		}
+	}
+	if(inst.cls == OOO_CLASS_STORE){
+		m->store_addr[set] = addr;
+		m->store_ready[set] = complete;
+	}
+
+	/* branches resolve at execute; a mispredict refetches the cycle after */
+	if(inst.is_cond_branch || inst.is_indirect){
+		m->branches++;
+		slot = (pc >> 2) & (OOO_BPRED_SIZE - 1);
+		if(inst.is_cond_branch){
+			predicted = m->bimodal[slot] >= 2;
+			if(taken && m->bimodal[slot] < 3) m->bimodal[slot]++;
+			if(!taken && m->bimodal[slot] > 0) m->bimodal[slot]--;
+		}
+		else{
+			predicted = taken = m->indirect_target[slot] == next_pc;
+			m->indirect_target[slot] = next_pc;
+		}
+		if(predicted != taken){
+			m->mispredicts++;
+			m->redirect_cycle = complete + 1;
+		}
+	}
+
+	/* commit: in order, commit_width per cycle */
+	commit = complete + 1;
+	if(commit <= m->commit_cycle){
+		commit = m->commit_cycle;
+		if(m->commit_count >= c->commit_width){
+			commit++;
+		}
+		else{
+			cause = OOO_CRIT_COMMIT;
+		}
+	}
+	oldest = m->commit_cycle;
+	if(commit > m->commit_cycle){
+		m->commit_cycle = commit;
+		m->commit_count = 0;
+	}
+	m->commit_count++;
+	if(commit > oldest){
+		m->critical[commit == complete + 1 ? cause : OOO_CRIT_COMMIT] += commit - oldest;
+	}
+
+	m->rob_commit[m->instructions % c->rob_size] = commit;
+	if(is_mem){
+		m->lsq_commit[m->num_mem++ % c->lsq_size] = commit;
+	}
+	if(renames){
+		m->prf_commit[m->num_renamed++ % free_regs] = commit;
+	}
+	m->instructions++;
+}
+
+/************************************************************/
+/* Print IPC, stalls and the critical-path breakdown                                              */
+/************************************************************/
+void ooo_report(const ooo_model_t *m){
+	static const char *class_names[OOO_NUM_CLASSES] = { "ALU", "branch", "mult", "div", "load", "store", "FPU" };
+	static const char *stall_names[OOO_NUM_STALLS] = { "ROB full", "RS full", "LSQ full", "PRF full" };
+	static const char *crit_names[OOO_CRIT_DEP] = { "commit bandwidth", "fetch", "branch mispredict", "dispatch width", "structural (ROB/RS/LSQ/PRF)", "issue/unit contention" };
+	ooo_config_t *c = &OOO_CONFIG;
+	double cycles;
+	int i;
+
+	if(m == NULL){
+		printf("Timing model is off; use 'ooo on' first.\n\n");
+		return;
+	}
+	cycles = m->commit_cycle ? (double)m->commit_cycle : 1.0;
+
+	printf("-------------------------------------------------------------\n");
+	printf("Out-of-order timing model\n");
+	printf("-------------------------------------------------------------\n");
+	printf("width fetch/dispatch/issue/commit\t: %u/%u/%u/%u\n", c->fetch_width, c->dispatch_width, c->issue_width, c->commit_width);
+	printf("ROB/RS/LSQ/PRF\t\t\t\t: %u/%u/%u/%u\n", c->rob_size, c->rs_size, c->lsq_size, c->phys_regs);
+	printf("-------------------------------------------------------------\n");
+	printf("instructions\t: %llu\n", (unsigned long long)m->instructions);
+	printf("cycles\t\t: %llu\n", (unsigned long long)m->commit_cycle);
+	printf("IPC\t\t: %.3f\n", m->instructions / cycles);
+	printf("branches\t: %llu (%llu mispredicted)\n", (unsigned long long)m->branches, (unsigned long long)m->mispredicts);
+	printf("-------------------------------------------------------------\n");
+	printf("[Class]\t\t[Count]\t[Units]\t[Latency]\n");
+	for(i = 0; i < OOO_NUM_CLASSES; i++){
+		printf("%s\t\t%llu\t%u\t%u\n", class_names[i], (unsigned long long)m->class_count[i], c->units[i], c->latency[i]);
+	}
+	printf("-------------------------------------------------------------\n");
+	printf("[Dispatch stall]\t[Cycles]\n");
+	for(i = 0; i < OOO_NUM_STALLS; i++){
+		printf("%s\t\t%llu\n", stall_names[i], (unsigned long long)m->stall[i]);
+	}
+	printf("-------------------------------------------------------------\n");
+	printf("[Critical path]\t\t\t[Cycles]\t[%%]\n");
+	for(i = 0; i < OOO_NUM_CRIT; i++){
+		if(i < OOO_CRIT_DEP){
+			printf("%-28s\t%llu\t%.1f\n", crit_names[i], (unsigned long long)m->critical[i], 100.0 * m->critical[i] / cycles);
+		}
+		else{
+			printf("data dep on %-16s\t%llu\t%.1f\n", class_names[i - OOO_CRIT_DEP], (unsigned long long)m->critical[i], 100.0 * m->critical[i] / cycles);
+		}
+	}
+	printf("-------------------------------------------------------------\n\n");
+}
+
+/************************************************************/
+/* Add the statistics of <part> (one interval) into <total>                                       */
+/************************************************************/
+void ooo_merge(ooo_model_t *total, const ooo_model_t *part){
+	int i;
+
+	total->instructions += part->instructions;
+	total->commit_cycle += part->commit_cycle;
+	total->num_mem += part->num_mem;
+	total->num_renamed += part->num_renamed;
+	total->branches += part->branches;
+	total->mispredicts += part->mispredicts;
+	for(i = 0; i < OOO_NUM_CLASSES; i++){
+		total->class_count[i] += part->class_count[i];
+	}
+	for(i = 0; i < OOO_NUM_STALLS; i++){
+		total->stall[i] += part->stall[i];
+	}
+	for(i = 0; i < OOO_NUM_CRIT; i++){
+		total->critical[i] += part->critical[i];
+	}
+}
+
+/************************************************************/
+/* Sample the model counters that advance by a fixed amount per loop iteration */
+/* once the loop reaches a steady state                                                                 */
+/************************************************************/
+void ooo_vector(uint64_t *v){
+	ooo_model_t *m = OOO_MODEL;
+	int i;
+
+	v[OOO_V_FETCH] = m->fetch_cycle;
+	v[OOO_V_DISPATCH] = m->dispatch_cycle;
+	v[OOO_V_COMMIT] = m->commit_cycle;
+	v[OOO_V_INSTRUCTIONS] = m->instructions;
+	v[OOO_V_MEM] = m->num_mem;
+	v[OOO_V_RENAMED] = m->num_renamed;
+	v[OOO_V_BRANCHES] = m->branches;
+	v[OOO_V_MISPREDICTS] = m->mispredicts;
+	v[OOO_V_FETCH_COUNT] = m->fetch_count;
+	v[OOO_V_DISPATCH_COUNT] = m->dispatch_count;
+	v[OOO_V_COMMIT_COUNT] = m->commit_count;
+	v[OOO_V_RS_COUNT] = m->rs_count;
+	for(i = 0; i < OOO_NUM_CLASSES; i++){
+		v[OOO_V_CLASS + i] = m->class_count[i];
+	}
+	for(i = 0; i < OOO_NUM_STALLS; i++){
+		v[OOO_V_STALL + i] = m->stall[i];
+	}
+	for(i = 0; i < OOO_NUM_CRIT; i++){
+		v[OOO_V_CRIT + i] = m->critical[i];
+	}
+}
+
+/************************************************************/
+/* Rotate a ring of <size> elements so element i moves to (i + by) % size            */
+/************************************************************/
+void ooo_rotate(void *ring, size_t elem, uint32_t size, uint32_t by){
+	uint8_t *tmp, *p = ring;
+
+	by %= size;
+	if(by == 0){
+		return;
+	}
+	tmp = malloc(elem * size);
+	assert(tmp != NULL);
+	memcpy(tmp + by * elem, p, (size - by) * elem);
+	memcpy(tmp, p + (size - by) * elem, by * elem);
+	memcpy(p, tmp, elem * size);
+	free(tmp);
+}
+
+/************************************************************/
+/* Put the model where <iterations> more steady-state iterations with per-iteration */
+/* counter changes <delta> would leave it. The model only compares and adds     */
+/* cycle numbers, so shifting every cycle value by the same amount (and rotating */
+/* the rings indexed by cycle or by instruction count) is exact                           */
+/************************************************************/
+void ooo_advance(uint64_t iterations, const uint64_t *delta){
+	ooo_model_t *m = OOO_MODEL;
+	ooo_config_t *c = &OOO_CONFIG;
+	uint64_t shift = iterations * delta[OOO_V_COMMIT];
+	uint32_t free_regs = c->phys_regs - OOO_ARCH_REGS;
+	uint32_t i;
+
+	m->fetch_cycle += shift;
+	m->dispatch_cycle += shift;
+	m->commit_cycle += shift;
+	m->redirect_cycle += shift;
+	for(i = 0; i < OOO_MAX_ROB; i++) m->rob_commit[i] += shift;
+	for(i = 0; i < OOO_MAX_LSQ; i++) m->lsq_commit[i] += shift;
+	for(i = 0; i < OOO_MAX_PRF; i++) m->prf_commit[i] += shift;
+	for(i = 0; i < m->rs_count; i++) m->rs_issue[i] += shift;
+	for(i = 0; i < OOO_ARCH_REGS; i++) m->reg_ready[i] += shift;
+	for(i = 0; i < OOO_MAX_UNITS; i++) m->div_busy[i] += shift;
+	for(i = 0; i < OOO_STORE_SETS; i++) m->store_ready[i] += shift;
+	for(i = 0; i < OOO_WINDOW; i++) m->slot_tag[i] += shift;
+
+	ooo_rotate(m->slot_tag, sizeof(m->slot_tag[0]), OOO_WINDOW, shift % OOO_WINDOW);
+	ooo_rotate(m->slot_issued, sizeof(m->slot_issued[0]), OOO_WINDOW, shift % OOO_WINDOW);
+	ooo_rotate(m->slot_units, sizeof(m->slot_units[0]), OOO_WINDOW, shift % OOO_WINDOW);
+	ooo_rotate(m->rob_commit, sizeof(uint64_t), c->rob_size, iterations * delta[OOO_V_INSTRUCTIONS] % c->rob_size);
+	ooo_rotate(m->lsq_commit, sizeof(uint64_t), c->lsq_size, iterations * delta[OOO_V_MEM] % c->lsq_size);
+	ooo_rotate(m->prf_commit, sizeof(uint64_t), free_regs, iterations * delta[OOO_V_RENAMED] % free_regs);
+
+	m->instructions += iterations * delta[OOO_V_INSTRUCTIONS];
+	m->num_mem += iterations * delta[OOO_V_MEM];
+	m->num_renamed += iterations * delta[OOO_V_RENAMED];
+	m->branches += iterations * delta[OOO_V_BRANCHES];
+	m->mispredicts += iterations * delta[OOO_V_MISPREDICTS];
+	for(i = 0; i < OOO_NUM_CLASSES; i++){
+		m->class_count[i] += iterations * delta[OOO_V_CLASS + i];
+	}
+	for(i = 0; i < OOO_NUM_STALLS; i++){
+		m->stall[i] += iterations * delta[OOO_V_STALL + i];
+	}
+	for(i = 0; i < OOO_NUM_CRIT; i++){
+		m->critical[i] += iterations * delta[OOO_V_CRIT + i];
+	}
+}
+
+/************************************************************/
+/* ooo on|off|stats|reset|set <param> <value>                                                       */
+/************************************************************/
+void ooo_command(){
+	static const char *params[] = {
+		"fetch", "dispatch", "issue", "commit", "rob", "rs", "lsq", "prf", "depth",
+		"alu", "branch", "mult", "div", "load", "store", "fpu",
+		"lat_alu", "lat_branch", "lat_mult", "lat_div", "lat_load", "lat_store", "lat_fpu"
+	};
+	static const uint32_t limits[] = {
+		OOO_MAX_WIDTH, OOO_MAX_WIDTH, OOO_MAX_WIDTH, OOO_MAX_WIDTH, OOO_MAX_ROB, OOO_MAX_RS, OOO_MAX_LSQ, OOO_MAX_PRF, 64,
+		OOO_MAX_UNITS, OOO_MAX_UNITS, OOO_MAX_UNITS, OOO_MAX_UNITS, OOO_MAX_UNITS, OOO_MAX_UNITS, OOO_MAX_UNITS,
+		256, 256, 256, 256, 256, 256, 256
+	};
+	uint32_t *fields[] = {
+		&OOO_CONFIG.fetch_width, &OOO_CONFIG.dispatch_width, &OOO_CONFIG.issue_width, &OOO_CONFIG.commit_width,
+		&OOO_CONFIG.rob_size, &OOO_CONFIG.rs_size, &OOO_CONFIG.lsq_size, &OOO_CONFIG.phys_regs, &OOO_CONFIG.frontend_depth,
+		&OOO_CONFIG.units[0], &OOO_CONFIG.units[1], &OOO_CONFIG.units[2], &OOO_CONFIG.units[3], &OOO_CONFIG.units[4], &OOO_CONFIG.units[5], &OOO_CONFIG.units[6],
+		&OOO_CONFIG.latency[0], &OOO_CONFIG.latency[1], &OOO_CONFIG.latency[2], &OOO_CONFIG.latency[3], &OOO_CONFIG.latency[4], &OOO_CONFIG.latency[5], &OOO_CONFIG.latency[6]
+	};
+	char command[20], param[20];
+	uint32_t value, minimum;
+	size_t i;
+
+	if(scanf("%19s", command) != 1){
+		return;
+	}
+	if(strcasecmp(command, "on") == 0){
+		ooo_reset();
+		printf("Timing model on.\n\n");
+	}
+	else if(strcasecmp(command, "off") == 0){
+		free(OOO_MODEL);
+		OOO_MODEL = NULL;
+		printf("Timing model off.\n\n");
+	}
+	else if(strcasecmp(command, "reset") == 0){
+		if(OOO_MODEL != NULL) ooo_reset();
+	}
+	else if(strcasecmp(command, "stats") == 0){
+		ooo_report(OOO_MODEL);
+	}
+	else if(strcasecmp(command, "set") == 0){
+		if(scanf("%19s %u", param, &value) != 2){
+			return;
+		}
+		for(i = 0; i < sizeof(params) / sizeof(params[0]); i++){
+			if(strcasecmp(param, params[i]) == 0) break;
+		}
+		if(i == sizeof(params) / sizeof(params[0])){
+			printf("Unknown timing model parameter %s.\n\n", param);
+			return;
+		}
+		/* the PRF must hold every architectural register plus one rename; latencies may be 1 */
+		minimum = fields[i] == &OOO_CONFIG.phys_regs ? OOO_ARCH_REGS + 1 : (fields[i] == &OOO_CONFIG.frontend_depth ? 0 : 1);
+		if(value < minimum || value > limits[i]){
+			printf("%s must be between %u and %u.\n\n", params[i], minimum, limits[i]);
+			return;
+		}
+		*fields[i] = value;
+		if(OOO_MODEL != NULL) ooo_reset();
+		printf("%s = %u (timing model reset)\n\n", params[i], value);
+	}
+	else{
+		printf("Usage: ooo on|off|stats|reset|set <param> <value>\n\n");
+	}
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <errno.h>
+
+#include "mu-mips.h"
+
+perf_stats_t PERF_STATS;
+int PERF_SUMMARY;
+
+/***************************************************************/
+/* Open the host counters once; any the host refuses stay at fd -1              */
+/***************************************************************/
+void perf_open() {
+	static const uint32_t types[PERF_NUM_COUNTERS] = {
+		PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+		PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE
+	};
+	static const uint64_t configs[PERF_NUM_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_BRANCH_MISSES,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_SW_TASK_CLOCK
+	};
+	struct perf_event_attr attr;
+	int i;
+
+	for (i = 0; i < PERF_NUM_COUNTERS; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = types[i];
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		PERF_STATS.fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		PERF_STATS.error[i] = PERF_STATS.fd[i] < 0 ? errno : 0;
+	}
+	PERF_STATS.opened = TRUE;
+}
+
+/***************************************************************/
+/* Start measuring a run                                                                                        */
+/***************************************************************/
+void perf_begin() {
+	int i;
+
+	if (!PERF_STATS.opened) {
+		perf_open();
+	}
+	PERF_STATS.start_count = INSTRUCTION_COUNT;
+	PERF_STATS.start_elided = FF.elided;
+	clock_gettime(CLOCK_MONOTONIC, &PERF_STATS.start);
+	for (i = 0; i < PERF_NUM_COUNTERS; i++) {
+		if (PERF_STATS.fd[i] >= 0) {
+			ioctl(PERF_STATS.fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(PERF_STATS.fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+/***************************************************************/
+/* Stop measuring and keep the results for the stats command                            */
+/***************************************************************/
+void perf_end() {
+	struct timespec stop;
+	uint64_t buf[3]; /* value, time enabled, time running */
+	int i;
+
+	for (i = 0; i < PERF_NUM_COUNTERS; i++) {
+		if (PERF_STATS.fd[i] >= 0) {
+			ioctl(PERF_STATS.fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	for (i = 0; i < PERF_NUM_COUNTERS; i++) {
+		PERF_STATS.value[i] = 0;
+		if (PERF_STATS.fd[i] < 0) continue;
+		if (read(PERF_STATS.fd[i], buf, sizeof(buf)) == sizeof(buf) && buf[2] > 0) {
+			/* scale up if the kernel multiplexed this counter */
+			PERF_STATS.value[i] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+		}
+	}
+	PERF_STATS.wall_ns = (uint64_t)(stop.tv_sec - PERF_STATS.start.tv_sec) * 1000000000ULL + stop.tv_nsec - PERF_STATS.start.tv_nsec;
+	/* skipped loop iterations cost the host almost nothing; normalizing by them would hide the interpreter's cost */
+	PERF_STATS.elided = FF.elided - PERF_STATS.start_elided;
+	PERF_STATS.sim_instructions = INSTRUCTION_COUNT - PERF_STATS.start_count - PERF_STATS.elided;
+	PERF_STATS.valid = TRUE;
+
+	if (PERF_SUMMARY) {
+		perf_report();
+	}
+}
+
+/***************************************************************/
+/* Print the last run's host counters, normalized per simulated instruction      */
+/***************************************************************/
+void perf_report() {
+	static const char *names[PERF_NUM_COUNTERS] = {
+		"cycles", "instructions", "branch-misses", "L1D-read-misses", "LLC-read-misses", "task-clock (ns)"
+	};
+	double n;
+	int i;
+
+	if (!PERF_STATS.valid) {
+		printf("No run measured yet; use run or sim first.\n\n");
+		return;
+	}
+	n = PERF_STATS.sim_instructions ? (double)PERF_STATS.sim_instructions : 1.0;
+
+	printf("-------------------------------------------------------------\n");
+	printf("Host counters for the last run (%llu simulated instructions)\n", (unsigned long long)PERF_STATS.sim_instructions);
+	printf("-------------------------------------------------------------\n");
+	if (PERF_STATS.elided > 0) {
+		printf("fast-forwarded		%llu instructions, not counted below\n", (unsigned long long)PERF_STATS.elided);
+	}
+	printf("[Counter]\t\t[Total]\t\t[Per sim instruction]\n");
+	printf("wall time (ns)\t\t%llu\t%.2f\n", (unsigned long long)PERF_STATS.wall_ns, PERF_STATS.wall_ns / n);
+	for (i = 0; i < PERF_NUM_COUNTERS; i++) {
+		if (PERF_STATS.fd[i] < 0) {
+			printf("%-16s\tnot available (%s)\n", names[i], strerror(PERF_STATS.error[i]));
+		}
+		else {
+			printf("%-16s\t%llu\t%.2f\n", names[i], (unsigned long long)PERF_STATS.value[i], PERF_STATS.value[i] / n);
+		}
+	}
+	printf("-------------------------------------------------------------\n");
+	if (PERF_STATS.fd[PERF_CYCLES] >= 0 && PERF_STATS.fd[PERF_INSTRUCTIONS] >= 0 && PERF_STATS.value[PERF_CYCLES] > 0) {
+		printf("host IPC\t\t%.2f\n", (double)PERF_STATS.value[PERF_INSTRUCTIONS] / PERF_STATS.value[PERF_CYCLES]);
+	}
+	if (PERF_STATS.wall_ns > 0) {
+		printf("simulated MIPS\t\t%.2f\n", PERF_STATS.sim_instructions * 1000.0 / PERF_STATS.wall_ns);
+		if (PERF_STATS.fd[PERF_TASK_CLOCK] >= 0 && PERF_STATS.value[PERF_TASK_CLOCK] <= PERF_STATS.wall_ns) {
+			printf("off-CPU (I/O, waits)\t%.1f%%\n", 100.0 * (PERF_STATS.wall_ns - PERF_STATS.value[PERF_TASK_CLOCK]) / PERF_STATS.wall_ns);
+		}
+	}
+	printf("-------------------------------------------------------------\n\n");
+}
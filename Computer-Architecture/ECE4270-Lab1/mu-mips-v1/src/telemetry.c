@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <strings.h>
+
+#include "mu-mips.h"
+
+telemetry_t TELEMETRY;
+__thread uint64_t TELEMETRY_NEXT = UINT64_MAX;
+
+/***************************************************************/
+/* Publish the simulator's counters for the telemetry thread. Called by  */
+/* the thread that started telemetry every TELEMETRY_SNAPSHOT                  */
+/* instructions and between commands, so the hot loop never shares      */
+/* its own state with the sampler                                                                   */
+/***************************************************************/
+void telemetry_snapshot() {
+	if (!TELEMETRY.running) {
+		TELEMETRY_NEXT = UINT64_MAX;
+		event_schedule();
+		return;
+	}
+	__atomic_store_n(&TELEMETRY.instructions, INSTRUCTION_COUNT, __ATOMIC_RELAXED);
+	__atomic_store_n(&TELEMETRY.pc, CURRENT_STATE.PC, __ATOMIC_RELAXED);
+	__atomic_store_n(&TELEMETRY.dirty, DIRTY_COUNT, __ATOMIC_RELAXED);
+	__atomic_store_n(&TELEMETRY.run_flag, RUN_FLAG, __ATOMIC_RELAXED);
+	TELEMETRY_NEXT = INSTRUCTION_COUNT + TELEMETRY_SNAPSHOT;
+	event_schedule();
+}
+
+/***************************************************************/
+/* Count one PC sample against its block (telemetry thread only)            */
+/***************************************************************/
+void telemetry_sample(uint32_t pc) {
+	uint32_t block = pc >> TELEMETRY_BLOCK_SHIFT;
+	uint32_t i = (block * 0x9E3779B1) & (TELEMETRY_HOT_SIZE - 1);
+	uint32_t n;
+
+	for (n = 0; n < TELEMETRY_HOT_SIZE; n++, i = (i + 1) & (TELEMETRY_HOT_SIZE - 1)) {
+		if (TELEMETRY.hot[i].samples == 0) {
+			TELEMETRY.hot[i].block = block;
+		}
+		if (TELEMETRY.hot[i].block == block) {
+			TELEMETRY.hot[i].samples++;
+			TELEMETRY.window_samples++;
+			return;
+		}
+	}
+}
+
+/***************************************************************/
+/* One telemetry record: key=value pairs on a single line. Hot blocks  */
+/* are the top sampled blocks with their share of recent samples; the  */
+/* samples are then halved so the list follows phase changes                  */
+/***************************************************************/
+int telemetry_format(char *line, size_t size, double elapsed, double mips, uint32_t pc) {
+	telemetry_hot_t top[TELEMETRY_HOT_TOP];
+	int len, i, j, num_top = 0;
+
+	len = snprintf(line, size, "seq=%llu t=%.3f insts=%llu mips=%.2f pc=0x%08x running=%d dirty=%u hot=",
+		(unsigned long long)TELEMETRY.published, elapsed, (unsigned long long)__atomic_load_n(&TELEMETRY.instructions, __ATOMIC_RELAXED), mips, pc,
+		__atomic_load_n(&TELEMETRY.run_flag, __ATOMIC_RELAXED), __atomic_load_n(&TELEMETRY.dirty, __ATOMIC_RELAXED));
+
+	for (i = 0; i < TELEMETRY_HOT_SIZE; i++) {
+		if (TELEMETRY.hot[i].samples == 0) continue;
+		for (j = num_top; j > 0 && top[j - 1].samples < TELEMETRY.hot[i].samples; j--) {
+			if (j < TELEMETRY_HOT_TOP) top[j] = top[j - 1];
+		}
+		if (j < TELEMETRY_HOT_TOP) {
+			top[j] = TELEMETRY.hot[i];
+			if (num_top < TELEMETRY_HOT_TOP) num_top++;
+		}
+	}
+	for (i = 0; i < num_top && len < (int)size; i++) {
+		len += snprintf(line + len, size - len, "%s0x%08x:%u%%", i ? "," : "", top[i].block << TELEMETRY_BLOCK_SHIFT,
+			(uint32_t)(100ULL * top[i].samples / TELEMETRY.window_samples));
+	}
+	if (num_top == 0 && len < (int)size) {
+		len += snprintf(line + len, size - len, "-");
+	}
+	if (len < (int)size - 1) {
+		line[len++] = '\n';
+		line[len] = '\0';
+	}
+	else {
+		len = size - 1;
+	}
+
+	/* decay: rehash what survives halving */
+	memcpy(TELEMETRY.decay, TELEMETRY.hot, sizeof(TELEMETRY.hot));
+	memset(TELEMETRY.hot, 0, sizeof(TELEMETRY.hot));
+	TELEMETRY.window_samples = 0;
+	for (i = 0; i < TELEMETRY_HOT_SIZE; i++) {
+		for (j = TELEMETRY.decay[i].samples / 2; j > 0; j--) {
+			telemetry_sample(TELEMETRY.decay[i].block << TELEMETRY_BLOCK_SHIFT);
+		}
+	}
+	return len;
+}
+
+/***************************************************************/
+/* Send a record to every connected client (dropping any that can't    */
+/* keep up), or append it to the file, rotating it when it grows large   */
+/***************************************************************/
+void telemetry_publish(const char *line, int len) {
+	char rotated[sizeof(TELEMETRY.path) + 2];
+	int i, fd;
+
+	if (TELEMETRY.mode == TELEMETRY_SOCKET) {
+		while (TELEMETRY.num_clients < TELEMETRY_MAX_CLIENTS && (fd = accept(TELEMETRY.listen_fd, NULL, NULL)) >= 0) {
+			TELEMETRY.clients[TELEMETRY.num_clients++] = fd;
+		}
+		for (i = 0; i < TELEMETRY.num_clients; ) {
+			if (send(TELEMETRY.clients[i], line, len, MSG_NOSIGNAL | MSG_DONTWAIT) != len) {
+				close(TELEMETRY.clients[i]);
+				TELEMETRY.clients[i] = TELEMETRY.clients[--TELEMETRY.num_clients];
+			}
+			else {
+				i++;
+			}
+		}
+	}
+	else {
+		/* a file that couldn't be reopened after rotating is retried every publish */
+		if (TELEMETRY.file == NULL) {
+			TELEMETRY.file = fopen(TELEMETRY.path, "a");
+			if (TELEMETRY.file == NULL) {
+				if (!TELEMETRY.reopen_failed) {
+					fprintf(stderr, "Error: telemetry can't reopen %s: %s\n", TELEMETRY.path, strerror(errno));
+					TELEMETRY.reopen_failed = TRUE;
+				}
+				return;
+			}
+			TELEMETRY.reopen_failed = FALSE;
+		}
+		fwrite(line, 1, len, TELEMETRY.file);
+		fflush(TELEMETRY.file);
+		if (ftell(TELEMETRY.file) > TELEMETRY_FILE_MAX) {
+			fclose(TELEMETRY.file);
+			snprintf(rotated, sizeof(rotated), "%s.1", TELEMETRY.path);
+			rename(TELEMETRY.path, rotated);
+			TELEMETRY.file = NULL;
+		}
+	}
+	TELEMETRY.published++;
+}
+
+/***************************************************************/
+/* Telemetry thread: samples the simulating thread's PC every                */
+/* TELEMETRY_SAMPLE_US and publishes a record every period. It only      */
+/* reads the snapshot the simulator publishes                                           */
+/***************************************************************/
+void *telemetry_main(void *arg) {
+	struct timespec tick = { 0, TELEMETRY_SAMPLE_US * 1000 };
+	struct timespec start, now, last;
+	char line[TELEMETRY_LINE_MAX];
+	uint64_t count, previous, last_total = 0;
+	uint32_t pc;
+	double interval;
+	int len;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	last = start;
+	previous = __atomic_load_n(&TELEMETRY.instructions, __ATOMIC_RELAXED);
+	while (__atomic_load_n(&TELEMETRY.running, __ATOMIC_RELAXED)) {
+		nanosleep(&tick, NULL);
+		count = __atomic_load_n(&TELEMETRY.instructions, __ATOMIC_RELAXED);
+		pc = __atomic_load_n(&TELEMETRY.pc, __ATOMIC_RELAXED);
+		/* going backwards is a reset or a reverse step, not progress */
+		if (count > previous) {
+			TELEMETRY.instructions_total += count - previous;
+			telemetry_sample(pc);
+		}
+		previous = count;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		interval = (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9;
+		if (interval * 1000 < TELEMETRY.period_ms) {
+			continue;
+		}
+		len = telemetry_format(line, sizeof(line), (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9,
+			(TELEMETRY.instructions_total - last_total) / interval / 1e6, pc);
+		telemetry_publish(line, len);
+		last = now;
+		last_total = TELEMETRY.instructions_total;
+	}
+	return NULL;
+}
+
+/***************************************************************/
+/* Start publishing to a Unix socket or file every <period_ms>                */
+/***************************************************************/
+void telemetry_start(int mode, const char *path, uint32_t period_ms) {
+	static int registered;
+	struct sockaddr_un addr;
+	struct stat st;
+
+	telemetry_stop();
+	memset(&addr, 0, sizeof(addr));
+	if (strlen(path) >= sizeof(addr.sun_path) || strlen(path) >= sizeof(TELEMETRY.path)) {
+		printf("Error: telemetry path too long.\n\n");
+		return;
+	}
+
+	TELEMETRY.mode = mode;
+	strcpy(TELEMETRY.path, path);
+	TELEMETRY.period_ms = period_ms ? period_ms : 1;
+	TELEMETRY.num_clients = 0;
+	TELEMETRY.listen_fd = -1;
+	TELEMETRY.file = NULL;
+	TELEMETRY.reopen_failed = FALSE;
+	if (mode == TELEMETRY_SOCKET) {
+		/* replace a stale socket, but never anything else that happens to be at <path> */
+		if (lstat(path, &st) == 0) {
+			if (!S_ISSOCK(st.st_mode)) {
+				printf("Error: %s exists and is not a socket.\n\n", path);
+				return;
+			}
+			unlink(path);
+		}
+		addr.sun_family = AF_UNIX;
+		strcpy(addr.sun_path, path);
+		TELEMETRY.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (TELEMETRY.listen_fd < 0 || bind(TELEMETRY.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(TELEMETRY.listen_fd, TELEMETRY_MAX_CLIENTS) != 0) {
+			printf("Error: can't listen on %s: %s\n\n", path, strerror(errno));
+			if (TELEMETRY.listen_fd >= 0) close(TELEMETRY.listen_fd);
+			return;
+		}
+	}
+	else {
+		TELEMETRY.file = fopen(path, "a");
+		if (TELEMETRY.file == NULL) {
+			printf("Error: can't open %s: %s\n\n", path, strerror(errno));
+			return;
+		}
+	}
+
+	memset(TELEMETRY.hot, 0, sizeof(TELEMETRY.hot));
+	TELEMETRY.window_samples = 0;
+	TELEMETRY.instructions_total = TELEMETRY.published = 0;
+	TELEMETRY.running = TRUE;
+	telemetry_snapshot();
+	if (pthread_create(&TELEMETRY.thread, NULL, telemetry_main, NULL) != 0) {
+		TELEMETRY.running = FALSE;
+		TELEMETRY_NEXT = UINT64_MAX;
+		event_schedule();
+		printf("Error: can't start the telemetry thread.\n\n");
+		return;
+	}
+	if (!registered) {
+		atexit(telemetry_stop);
+		registered = TRUE;
+	}
+	printf("Publishing telemetry to %s %s every %u ms.\n\n", mode == TELEMETRY_SOCKET ? "socket" : "file", path, TELEMETRY.period_ms);
+}
+
+/***************************************************************/
+/* Stop the telemetry thread and close its socket or file                     */
+/***************************************************************/
+void telemetry_stop() {
+	struct stat st;
+	int i;
+
+	if (!TELEMETRY.running) {
+		return;
+	}
+	__atomic_store_n(&TELEMETRY.running, FALSE, __ATOMIC_RELAXED);
+	pthread_join(TELEMETRY.thread, NULL);
+	TELEMETRY_NEXT = UINT64_MAX;
+	event_schedule();
+	for (i = 0; i < TELEMETRY.num_clients; i++) {
+		close(TELEMETRY.clients[i]);
+	}
+	TELEMETRY.num_clients = 0;
+	if (TELEMETRY.listen_fd >= 0) {
+		close(TELEMETRY.listen_fd);
+		if (lstat(TELEMETRY.path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+			unlink(TELEMETRY.path);
+		}
+		TELEMETRY.listen_fd = -1;
+	}
+	if (TELEMETRY.file != NULL) {
+		fclose(TELEMETRY.file);
+		TELEMETRY.file = NULL;
+	}
+}
+
+/***************************************************************/
+/* telemetry socket|file <path> <ms>, telemetry off|stats                        */
+/***************************************************************/
+void telemetry_command() {
+	char command[20], path[256];
+	uint32_t period_ms;
+
+	if (scanf("%19s", command) != 1) {
+		return;
+	}
+	if (strcasecmp(command, "socket") == 0 || strcasecmp(command, "file") == 0) {
+		if (scanf("%255s %u", path, &period_ms) != 2) {
+			return;
+		}
+		telemetry_start(strcasecmp(command, "socket") == 0 ? TELEMETRY_SOCKET : TELEMETRY_FILE, path, period_ms);
+	}
+	else if (strcasecmp(command, "off") == 0) {
+		telemetry_stop();
+		printf("Telemetry off.\n\n");
+	}
+	else if (strcasecmp(command, "stats") == 0) {
+		if (!TELEMETRY.running) {
+			printf("Telemetry off.\n\n");
+			return;
+		}
+		printf("Telemetry to %s %s every %u ms: %llu records, %d clients, %u pages written\n\n",
+			TELEMETRY.mode == TELEMETRY_SOCKET ? "socket" : "file", TELEMETRY.path, TELEMETRY.period_ms,
+			(unsigned long long)__atomic_load_n(&TELEMETRY.published, __ATOMIC_RELAXED), __atomic_load_n(&TELEMETRY.num_clients, __ATOMIC_RELAXED), DIRTY_COUNT);
+	}
+	else {
+		printf("Usage: telemetry socket|file <path> <ms> | off | stats\n\n");
+	}
+}
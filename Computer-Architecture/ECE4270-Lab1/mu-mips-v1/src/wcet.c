@@ -0,0 +1,676 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <strings.h>
+
+#include "mu-mips.h"
+
+wcet_bound_t WCET_BOUNDS[WCET_MAX_BOUNDS];
+int WCET_NUM_BOUNDS;
+uint32_t WCET_LATENCY[OOO_NUM_CLASSES] = { 1, 1, 4, 35, 3, 1, 4 };
+
+/************************************************************/
+/* Saturating arithmetic for cycle bounds                                                             */
+/************************************************************/
+uint64_t wcet_add(uint64_t a, uint64_t b){
+	return a > WCET_UNBOUNDED - b ? WCET_UNBOUNDED : a + b;
+}
+
+uint64_t wcet_mul(uint64_t a, uint64_t b){
+	return b != 0 && a > WCET_UNBOUNDED / b ? WCET_UNBOUNDED : a * b;
+}
+
+/************************************************************/
+/* Control-flow kind of the instruction at <addr>; *target gets the branch/jump    */
+/* destination, decoded the way handle_instruction() executes it                        */
+/************************************************************/
+int wcet_decode(uint32_t addr, uint32_t instruction, uint32_t *target){
+	uint32_t opcode = (instruction & 0xFC000000) >> 26;
+	uint32_t function = instruction & 0x0000003F;
+	uint32_t rt = (instruction & 0x001F0000) >> 16;
+	uint32_t rs = (instruction & 0x03E00000) >> 21;
+	uint32_t immediate = instruction & 0x0000FFFF;
+
+	*target = addr + ((immediate & 0x8000) > 0 ? (immediate | 0xFFFF0000) << 2 : (immediate & 0x0000FFFF) << 2);
+	switch(opcode){
+		case 0x00:
+			if(function == 0x08) return rs == 31 ? WCET_RETURN : WCET_IJUMP; //JR
+			if(function == 0x09) return WCET_ICALL;   //JALR
+			if(function == 0x0C) return WCET_SYSCALL; //SYSCALL
+			return WCET_SEQ;
+		case 0x01:
+			return rt == 0x00 || rt == 0x01 ? WCET_BRANCH : WCET_SEQ; //BLTZ, BGEZ
+		case 0x04: //BEQ
+		case 0x05: //BNE
+		case 0x06: //BLEZ
+		case 0x07: //BGTZ
+			return WCET_BRANCH;
+		case 0x02: //J
+		case 0x03: //JAL
+			*target = (addr & 0xF0000000) | ((instruction & 0x03FFFFFF) << 2);
+			return opcode == 0x02 ? WCET_JUMP : WCET_CALL;
+		case 0x10: //COP0
+			return (instruction & 0x02000000) && function == 0x18 ? WCET_RETURN : WCET_SEQ; //ERET
+		case 0x11: //COP1
+			return ((instruction & 0x03E00000) >> 21) == 0x08 ? WCET_BRANCH : WCET_SEQ; //BC1T, BC1F
+		default:
+			return WCET_SEQ;
+	}
+}
+
+/************************************************************/
+/* Split the text into basic blocks, link successors, and find the functions         */
+/* (the text start plus every JAL target)                                                                */
+/************************************************************/
+void wcet_build(wcet_t *w){
+	uint8_t *leader;
+	uint32_t i, addr, target;
+	int kind, b, f, top, *stack;
+	ooo_inst_t inst;
+
+	w->num_insts = PROGRAM_SIZE;
+	leader = calloc(w->num_insts + 1, 1);
+	w->block_of = malloc(w->num_insts * sizeof(int));
+	w->functions = malloc((w->num_insts + 1) * sizeof(wcet_function_t));
+	assert(leader != NULL && w->block_of != NULL && w->functions != NULL);
+
+	leader[0] = TRUE;
+	for(i = 0; i < w->num_insts; i++){
+		addr = MEM_TEXT_BEGIN + 4 * i;
+		kind = wcet_decode(addr, mem_read_32(addr), &target);
+		if(kind != WCET_SEQ){
+			leader[i + 1] = TRUE;
+		}
+		if((kind == WCET_BRANCH || kind == WCET_JUMP || kind == WCET_CALL) && WCET_IN_TEXT(w, target)){
+			leader[(target - MEM_TEXT_BEGIN) / 4] = TRUE;
+		}
+	}
+
+	w->num_blocks = 0;
+	for(i = 0; i < w->num_insts; i++){
+		w->num_blocks += leader[i];
+	}
+	w->blocks = calloc(w->num_blocks, sizeof(wcet_block_t));
+	assert(w->blocks != NULL);
+	for(i = 0, b = -1; i < w->num_insts; i++){
+		addr = MEM_TEXT_BEGIN + 4 * i;
+		if(leader[i]){
+			w->blocks[++b].start = addr;
+			w->blocks[b].callee = w->blocks[b].loop = w->blocks[b].function = WCET_NONE;
+		}
+		w->blocks[b].end = addr;
+		w->block_of[i] = b;
+		ooo_decode(mem_read_32(addr), &inst);
+		w->blocks[b].cost += WCET_LATENCY[inst.cls];
+	}
+	free(leader);
+
+	/* successors follow the block's last instruction; there are no delay slots */
+	w->num_functions = 1;
+	w->functions[0].entry = 0;
+	for(b = 0; b < w->num_blocks; b++){
+		wcet_block_t *blk = &w->blocks[b];
+		addr = blk->end;
+		kind = wcet_decode(addr, mem_read_32(addr), &target);
+		if(kind == WCET_BRANCH || kind == WCET_JUMP){
+			if(WCET_IN_TEXT(w, target)){
+				blk->succ[blk->num_succ++] = w->block_of[(target - MEM_TEXT_BEGIN) / 4];
+			}
+			else{
+				w->escapes++;
+			}
+		}
+		if(kind == WCET_CALL){
+			if(WCET_IN_TEXT(w, target)){
+				for(f = 0; f < w->num_functions && w->functions[f].entry != w->block_of[(target - MEM_TEXT_BEGIN) / 4]; f++);
+				if(f == w->num_functions){
+					w->functions[w->num_functions++].entry = w->block_of[(target - MEM_TEXT_BEGIN) / 4];
+				}
+				blk->callee = f;
+			}
+			else{
+				w->escapes++;
+			}
+		}
+		if(kind == WCET_ICALL || kind == WCET_IJUMP){
+			blk->node_cost = WCET_UNBOUNDED; /* callee or target unknown */
+			w->indirect++;
+		}
+		if(kind != WCET_JUMP && kind != WCET_RETURN && kind != WCET_IJUMP && (addr - MEM_TEXT_BEGIN) / 4 + 1 < w->num_insts
+			&& !(blk->num_succ == 1 && blk->succ[0] == b + 1)){
+			blk->succ[blk->num_succ++] = b + 1;
+		}
+	}
+
+	/* each block belongs to the first function that reaches it without following calls;
+	   falling into another function's entry (e.g. past an exit syscall) ends the path */
+	stack = malloc(w->num_blocks * sizeof(int) * 2);
+	assert(stack != NULL);
+	for(f = 0; f < w->num_functions; f++){
+		w->functions[f].state = 0;
+		w->functions[f].wcet = 0;
+		w->functions[f].path = NULL;
+		w->functions[f].path_len = 0;
+		w->blocks[w->functions[f].entry].function = f;
+	}
+	for(f = 0; f < w->num_functions; f++){
+		top = 0;
+		stack[top++] = w->functions[f].entry;
+		while(top > 0){
+			b = stack[--top];
+			for(i = 0; i < (uint32_t)w->blocks[b].num_succ; i++){
+				if(w->blocks[w->blocks[b].succ[i]].function == WCET_NONE){
+					w->blocks[w->blocks[b].succ[i]].function = f;
+					stack[top++] = w->blocks[b].succ[i];
+				}
+			}
+		}
+	}
+	free(stack);
+
+	for(b = 0; b < w->num_blocks; b++){
+		w->blocks[b].rep = b;
+		w->blocks[b].next_member = WCET_NONE;
+	}
+	w->dist = malloc(w->num_blocks * sizeof(uint64_t));
+	w->next = malloc(w->num_blocks * sizeof(int));
+	w->mark = calloc(w->num_blocks, sizeof(int));
+	w->in_region = calloc(w->num_blocks, 1);
+	w->order = malloc(w->num_blocks * sizeof(int));
+	w->stack = malloc(w->num_blocks * sizeof(int));
+	w->cur_block = malloc(w->num_blocks * sizeof(int));
+	w->cur_succ = malloc(w->num_blocks * sizeof(int));
+	w->loops = malloc(w->num_blocks * sizeof(wcet_loop_t));
+	assert(w->dist != NULL && w->next != NULL && w->mark != NULL && w->in_region != NULL && w->loops != NULL);
+	assert(w->order != NULL && w->stack != NULL && w->cur_block != NULL && w->cur_succ != NULL);
+}
+
+/************************************************************/
+/* Next successor of representative <n> in the current region (resuming from        */
+/* cur_block/cur_succ), not taking edges back to <header>; WCET_NONE when done   */
+/************************************************************/
+int wcet_next_succ(wcet_t *w, int n, int header){
+	int b, s;
+
+	for(b = w->cur_block[n]; b != WCET_NONE; b = w->blocks[b].next_member, w->cur_succ[n] = 0){
+		w->cur_block[n] = b;
+		while(w->cur_succ[n] < w->blocks[b].num_succ){
+			s = w->blocks[b].succ[w->cur_succ[n]++];
+			if(!w->in_region[s]) continue;
+			s = w->blocks[s].rep;
+			if(s == n || s == header) continue;
+			return s;
+		}
+	}
+	w->cur_block[n] = WCET_NONE;
+	return WCET_NONE;
+}
+
+/************************************************************/
+/* Longest path from <start> over the blocks flagged in in_region; the path of        */
+/* representatives is stored in *path. An iterative DFS orders the region so every */
+/* successor is costed before its predecessors; an edge to a node still on the DFS */
+/* stack is a cycle that isn't a natural loop, and makes the paths through it         */
+/* WCET_UNBOUNDED                                                                                                       */
+/************************************************************/
+uint64_t wcet_longest(wcet_t *w, int start, int header, int **path, int *path_len){
+	uint64_t cost, best, d;
+	int b, n, s, top, num;
+
+	for(b = 0; b < w->num_blocks; b++){
+		w->mark[b] = 0;
+	}
+	num = top = 0;
+	w->mark[start] = 1;
+	w->cur_block[start] = start;
+	w->cur_succ[start] = 0;
+	w->stack[top++] = start;
+	while(top > 0){
+		n = w->stack[top - 1];
+		s = wcet_next_succ(w, n, header);
+		if(s == WCET_NONE){
+			w->mark[n] = 2;
+			w->order[num++] = n;
+			top--;
+		}
+		else if(w->mark[s] == 0){
+			w->mark[s] = 1;
+			w->cur_block[s] = s;
+			w->cur_succ[s] = 0;
+			w->stack[top++] = s;
+		}
+	}
+
+	/* post-order: successors first; mark 3 once dist is known */
+	for(b = 0; b < num; b++){
+		n = w->order[b];
+		best = 0;
+		w->next[n] = WCET_NONE;
+		w->cur_block[n] = n;
+		w->cur_succ[n] = 0;
+		while((s = wcet_next_succ(w, n, header)) != WCET_NONE){
+			d = w->mark[s] == 3 ? w->dist[s] : WCET_UNBOUNDED;
+			if(w->next[n] == WCET_NONE || d > best){
+				best = d;
+				w->next[n] = s;
+			}
+		}
+		w->dist[n] = wcet_add(w->blocks[n].node_cost, best);
+		w->mark[n] = 3;
+	}
+	cost = w->dist[start];
+	/* an unbounded path can run into a cycle; it ends where it would repeat */
+	*path_len = 0;
+	for(n = start; n != WCET_NONE && w->mark[n] != 4; n = w->next[n]){
+		w->mark[n] = 4;
+		(*path_len)++;
+	}
+	*path = malloc(*path_len * sizeof(int));
+	assert(*path != NULL);
+	for(n = start, b = 0; b < *path_len; n = w->next[n]){
+		(*path)[b++] = n;
+	}
+	return cost;
+}
+
+/************************************************************/
+/* Bound one function: callees first, then its natural loops innermost first, each */
+/* collapsed into its header with cost bound x worst iteration                          */
+/************************************************************/
+uint64_t wcet_function(wcet_t *w, int f){
+	wcet_function_t *fn = &w->functions[f];
+	wcet_loop_t *loop, tmp;
+	int *local, *index, n, i, j, k, b, s, changed, first, prev, top, *stack;
+	int *pred_start, *preds, *rpo, *order, *idom, *cursor, x, y;
+
+	if(fn->state == 2) return fn->wcet;
+	if(fn->state == 1){
+		w->recursive++;
+		return WCET_UNBOUNDED;
+	}
+	fn->state = 1;
+
+	/* the blocks of this function, with calls charged at the callee's bound */
+	local = malloc(w->num_blocks * sizeof(int));
+	index = malloc(w->num_blocks * sizeof(int));
+	assert(local != NULL && index != NULL);
+	for(b = 0, n = 0; b < w->num_blocks; b++){
+		index[b] = WCET_NONE;
+		if(w->blocks[b].function != f) continue;
+		index[b] = n;
+		local[n++] = b;
+		if(w->blocks[b].node_cost != WCET_UNBOUNDED){
+			w->blocks[b].node_cost = w->blocks[b].cost;
+			if(w->blocks[b].callee != WCET_NONE){
+				w->blocks[b].node_cost = wcet_add(w->blocks[b].cost, wcet_function(w, w->blocks[b].callee));
+			}
+		}
+	}
+
+	/* predecessors within the function: those of local block i are preds[pred_start[i]..pred_start[i + 1]) */
+	pred_start = calloc(n + 1, sizeof(int));
+	cursor = malloc((n + 1) * sizeof(int));
+	assert(pred_start != NULL && cursor != NULL);
+	for(i = 0; i < n; i++){
+		for(k = 0; k < w->blocks[local[i]].num_succ; k++){
+			b = w->blocks[local[i]].succ[k];
+			if(index[b] != WCET_NONE) pred_start[index[b] + 1]++;
+		}
+	}
+	for(i = 0; i < n; i++){
+		pred_start[i + 1] += pred_start[i];
+	}
+	preds = malloc((pred_start[n] + 1) * sizeof(int));
+	assert(preds != NULL);
+	memcpy(cursor, pred_start, (n + 1) * sizeof(int));
+	for(i = 0; i < n; i++){
+		for(k = 0; k < w->blocks[local[i]].num_succ; k++){
+			b = w->blocks[local[i]].succ[k];
+			if(index[b] != WCET_NONE) preds[cursor[index[b]]++] = i;
+		}
+	}
+
+	/* reverse postorder from the entry (every block of the function is reachable from it) */
+	rpo = malloc(n * sizeof(int));
+	order = malloc(n * sizeof(int));
+	idom = malloc(n * sizeof(int));
+	stack = malloc(n * sizeof(int));
+	assert(rpo != NULL && order != NULL && idom != NULL && stack != NULL);
+	for(i = 0; i < n; i++){
+		rpo[i] = WCET_NONE;
+		cursor[i] = 0;
+	}
+	j = n;
+	top = 0;
+	stack[top++] = index[fn->entry];
+	rpo[index[fn->entry]] = 0; /* on the stack; renumbered once finished */
+	while(top > 0){
+		i = stack[top - 1];
+		if(cursor[i] < w->blocks[local[i]].num_succ){
+			b = w->blocks[local[i]].succ[cursor[i]++];
+			if(index[b] != WCET_NONE && rpo[index[b]] == WCET_NONE){
+				rpo[index[b]] = 0;
+				stack[top++] = index[b];
+			}
+			continue;
+		}
+		top--;
+		order[--j] = i;
+	}
+	for(k = j; k < n; k++){
+		rpo[order[k]] = k - j;
+	}
+
+	/* immediate dominators (Cooper, Harvey and Kennedy): iterate to a fixed point in reverse postorder */
+	for(i = 0; i < n; i++){
+		idom[i] = WCET_NONE;
+	}
+	idom[index[fn->entry]] = index[fn->entry];
+	do {
+		changed = FALSE;
+		for(k = j + 1; k < n; k++){
+			i = order[k];
+			x = WCET_NONE;
+			for(s = pred_start[i]; s < pred_start[i + 1]; s++){
+				y = preds[s];
+				if(idom[y] == WCET_NONE) continue;
+				if(x == WCET_NONE){
+					x = y;
+					continue;
+				}
+				while(x != y){
+					while(rpo[x] > rpo[y]) x = idom[x];
+					while(rpo[y] > rpo[x]) y = idom[y];
+				}
+			}
+			if(idom[i] != x){
+				idom[i] = x;
+				changed = TRUE;
+			}
+		}
+	} while(changed);
+
+	/* natural loops: a back edge u -> h where h dominates u; loops sharing a header merge */
+	first = w->num_loops;
+	for(i = 0; i < n; i++){
+		for(k = 0; k < w->blocks[local[i]].num_succ; k++){
+			b = w->blocks[local[i]].succ[k];
+			if(index[b] == WCET_NONE || rpo[i] == WCET_NONE || rpo[index[b]] > rpo[i]) continue;
+			for(x = i; rpo[x] > rpo[index[b]]; x = idom[x]);
+			if(x != index[b]) continue;
+			for(j = first; j < w->num_loops && w->loops[j].header != b; j++);
+			loop = &w->loops[j];
+			if(j == w->num_loops){
+				w->num_loops++;
+				memset(loop, 0, sizeof(*loop));
+				loop->header = b;
+				loop->body = calloc(w->num_blocks, 1);
+				assert(loop->body != NULL);
+				loop->body[b] = TRUE;
+				loop->size = 1;
+				for(s = 0; s < WCET_NUM_BOUNDS; s++){
+					if(WCET_BOUNDS[s].header == w->blocks[b].start) loop->bound = WCET_BOUNDS[s].bound;
+				}
+			}
+			/* everything that reaches the latch without passing the header */
+			top = 0;
+			if(!loop->body[local[i]]){
+				loop->body[local[i]] = TRUE;
+				loop->size++;
+				stack[top++] = i;
+			}
+			while(top > 0){
+				x = stack[--top];
+				for(s = pred_start[x]; s < pred_start[x + 1]; s++){
+					y = preds[s];
+					if(!loop->body[local[y]]){
+						loop->body[local[y]] = TRUE;
+						loop->size++;
+						stack[top++] = y;
+					}
+				}
+			}
+		}
+	}
+	free(stack);
+	free(pred_start);
+	free(preds);
+	free(cursor);
+	free(rpo);
+	free(order);
+	free(idom);
+
+	/* innermost first: a nested loop's body is a subset of the enclosing one */
+	for(i = first + 1; i < w->num_loops; i++){
+		for(j = i; j > first && w->loops[j - 1].size > w->loops[j].size; j--){
+			tmp = w->loops[j];
+			w->loops[j] = w->loops[j - 1];
+			w->loops[j - 1] = tmp;
+		}
+	}
+	for(i = first; i < w->num_loops; i++){
+		loop = &w->loops[i];
+		for(b = 0; b < w->num_blocks; b++){
+			w->in_region[b] = loop->body[b];
+		}
+		loop->iteration = wcet_longest(w, loop->header, loop->header, &loop->path, &loop->path_len);
+		/* plus the header once more: the test that finally leaves a top-tested loop */
+		loop->total = loop->bound ? wcet_add(wcet_mul(loop->iteration, loop->bound), w->blocks[loop->header].node_cost) : WCET_UNBOUNDED;
+		w->blocks[loop->header].node_cost = loop->total;
+		w->blocks[loop->header].loop = i;
+		prev = loop->header;
+		for(b = 0; b < w->num_blocks; b++){
+			if(!loop->body[b]) continue;
+			w->blocks[b].rep = loop->header;
+			if(b != loop->header){
+				w->blocks[prev].next_member = b;
+				prev = b;
+			}
+		}
+		w->blocks[prev].next_member = WCET_NONE;
+	}
+
+	for(b = 0; b < w->num_blocks; b++){
+		w->in_region[b] = w->blocks[b].function == f;
+	}
+	fn->wcet = wcet_longest(w, w->blocks[fn->entry].rep, WCET_NONE, &fn->path, &fn->path_len);
+	fn->state = 2;
+	free(local);
+	free(index);
+	return fn->wcet;
+}
+
+/************************************************************/
+/* Print a cycle bound, or "unbounded"                                                                   */
+/************************************************************/
+void wcet_print_cycles(uint64_t cycles){
+	if(cycles == WCET_UNBOUNDED){
+		printf("unbounded");
+	}
+	else{
+		printf("%llu", (unsigned long long)cycles);
+	}
+}
+
+/************************************************************/
+/* Print a path of representatives; collapsed loops show as loop <header> x bound */
+/************************************************************/
+void wcet_print_path(wcet_t *w, const int *path, int path_len, int header){
+	int i, b;
+
+	for(i = 0; i < path_len; i++){
+		b = path[i];
+		printf("%s", i ? " -> " : "\t");
+		if(w->blocks[b].loop != WCET_NONE && b != header){
+			if(w->loops[w->blocks[b].loop].bound){
+				printf("loop 0x%08x x%u (", w->blocks[b].start, w->loops[w->blocks[b].loop].bound);
+			}
+			else{
+				printf("loop 0x%08x x? (", w->blocks[b].start);
+			}
+		}
+		else{
+			printf("0x%08x (", w->blocks[b].start);
+		}
+		if(b == header){
+			wcet_print_cycles(w->blocks[b].callee == WCET_NONE ? w->blocks[b].cost : wcet_add(w->blocks[b].cost, w->functions[w->blocks[b].callee].wcet));
+		}
+		else{
+			wcet_print_cycles(w->blocks[b].node_cost);
+		}
+		printf(")");
+	}
+	printf("\n");
+}
+
+/************************************************************/
+/* Build the CFG of the loaded text and print blocks, loops, functions and the      */
+/* worst-case path                                                                                                    */
+/************************************************************/
+void wcet_report(){
+	static const char *class_names[OOO_NUM_CLASSES] = { "alu", "branch", "mult", "div", "load", "store", "fpu" };
+	wcet_t w;
+	int i, b, unbounded;
+
+	if(PROGRAM_SIZE == 0){
+		printf("No program loaded.\n\n");
+		return;
+	}
+	memset(&w, 0, sizeof(w));
+	wcet_build(&w);
+	for(i = w.num_functions - 1; i >= 0; i--){
+		wcet_function(&w, i);
+	}
+
+	printf("-------------------------------------------------------------\n");
+	printf("WCET analysis: %u instructions, %d blocks, %d loops, %d functions\n", w.num_insts, w.num_blocks, w.num_loops, w.num_functions);
+	printf("latency (cycles):");
+	for(i = 0; i < OOO_NUM_CLASSES; i++){
+		printf(" %s %u", class_names[i], WCET_LATENCY[i]);
+	}
+	printf("\n-------------------------------------------------------------\n");
+	printf("[Block]\t\t\t[Instructions]\t[Cycles]\t[Successors]\n");
+	for(b = 0; b < w.num_blocks && b < WCET_MAX_LISTED; b++){
+		printf("0x%08x-0x%08x\t%u\t\t%llu\t\t", w.blocks[b].start, w.blocks[b].end, (w.blocks[b].end - w.blocks[b].start) / 4 + 1, (unsigned long long)w.blocks[b].cost);
+		for(i = 0; i < w.blocks[b].num_succ; i++){
+			printf("0x%08x ", w.blocks[w.blocks[b].succ[i]].start);
+		}
+		if(w.blocks[b].callee != WCET_NONE){
+			printf("call 0x%08x", w.blocks[w.functions[w.blocks[b].callee].entry].start);
+		}
+		printf("\n");
+	}
+	if(w.num_blocks > WCET_MAX_LISTED){
+		printf("... %d more blocks\n", w.num_blocks - WCET_MAX_LISTED);
+	}
+
+	printf("-------------------------------------------------------------\n");
+	printf("[Loop header]\t[Blocks]\t[Bound]\t\t[Iteration]\t[Total]\n");
+	unbounded = 0;
+	for(i = 0; i < w.num_loops; i++){
+		printf("0x%08x\t%d\t\t", w.blocks[w.loops[i].header].start, w.loops[i].size);
+		if(w.loops[i].bound){
+			printf("%u\t\t", w.loops[i].bound);
+		}
+		else{
+			printf("none\t\t");
+			unbounded++;
+		}
+		wcet_print_cycles(w.loops[i].iteration);
+		printf("\t\t");
+		wcet_print_cycles(w.loops[i].total);
+		printf("\n");
+		wcet_print_path(&w, w.loops[i].path, w.loops[i].path_len, w.loops[i].header);
+	}
+
+	printf("-------------------------------------------------------------\n");
+	printf("[Function]\t[WCET cycles]\n");
+	for(i = 0; i < w.num_functions; i++){
+		printf("0x%08x\t", w.blocks[w.functions[i].entry].start);
+		wcet_print_cycles(w.functions[i].wcet);
+		printf("\n");
+	}
+	printf("-------------------------------------------------------------\n");
+	printf("Hot path:\n");
+	wcet_print_path(&w, w.functions[0].path, w.functions[0].path_len, WCET_NONE);
+	printf("WCET\t: ");
+	wcet_print_cycles(w.functions[0].wcet);
+	printf(" cycles\n");
+	if(unbounded){
+		printf("%d loop(s) need a bound: wcet bound <header> <iterations>\n", unbounded);
+	}
+	if(w.recursive || w.indirect || w.escapes){
+		printf("%d recursive call(s), %d indirect jump(s)/call(s), %d branch(es) leaving the text\n", w.recursive, w.indirect, w.escapes);
+	}
+	printf("-------------------------------------------------------------\n\n");
+
+	for(i = 0; i < w.num_loops; i++){
+		free(w.loops[i].body);
+		free(w.loops[i].path);
+	}
+	for(i = 0; i < w.num_functions; i++){
+		free(w.functions[i].path);
+	}
+	free(w.loops);
+	free(w.functions);
+	free(w.blocks);
+	free(w.block_of);
+	free(w.dist);
+	free(w.next);
+	free(w.mark);
+	free(w.order);
+	free(w.stack);
+	free(w.cur_block);
+	free(w.cur_succ);
+	free(w.in_region);
+}
+
+/************************************************************/
+/* wcet report|bound <header> <n>|lat <class> <cycles>                                         */
+/************************************************************/
+void wcet_command(){
+	static const char *class_names[OOO_NUM_CLASSES] = { "alu", "branch", "mult", "div", "load", "store", "fpu" };
+	char command[20], name[20];
+	uint32_t header, value;
+	int i;
+
+	if(scanf("%19s", command) != 1){
+		return;
+	}
+	if(strcasecmp(command, "report") == 0){
+		wcet_report();
+	}
+	else if(strcasecmp(command, "bound") == 0){
+		if(scanf("%x %u", &header, &value) != 2){
+			return;
+		}
+		for(i = 0; i < WCET_NUM_BOUNDS && WCET_BOUNDS[i].header != header; i++);
+		if(i == WCET_MAX_BOUNDS){
+			printf("Error: at most %d loop bounds.\n\n", WCET_MAX_BOUNDS);
+			return;
+		}
+		if(i == WCET_NUM_BOUNDS){
+			WCET_NUM_BOUNDS++;
+		}
+		WCET_BOUNDS[i].header = header;
+		WCET_BOUNDS[i].bound = value;
+		printf("Loop at 0x%08x bounded to %u iterations.\n\n", header, value);
+	}
+	else if(strcasecmp(command, "lat") == 0){
+		if(scanf("%19s %u", name, &value) != 2){
+			return;
+		}
+		for(i = 0; i < OOO_NUM_CLASSES && strcasecmp(name, class_names[i]) != 0; i++);
+		if(i == OOO_NUM_CLASSES){
+			printf("Unknown class %s (alu, branch, mult, div, load, store, fpu).\n\n", name);
+			return;
+		}
+		WCET_LATENCY[i] = value;
+		printf("%s latency = %u cycles.\n\n", class_names[i], value);
+	}
+	else{
+		printf("Usage: wcet report|bound <header> <n>|lat <class> <cycles>\n\n");
+	}
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Run each guest program under tests/ with its <name>.cmd on stdin and check that the
+# lines of <name>.expect appear, exactly and in order, in the simulator's output. Each
+# program runs in its own scratch directory, so files it writes (fuzz-out/, telemetry)
+# don't collide; if there is a <name>.sh, it runs there afterwards to check those files and
+# its output is checked along with the simulator's.
+# usage: check.sh <simulator> [name...]
+
+SIM=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=${TMPDIR:-/tmp}/mu-mips-check.$$
+pass=0
+fail=0
+
+if [ $# -eq 0 ]; then
+	set -- $(cd "$DIR" && ls *.cmd | sed 's/\.cmd$//')
+fi
+
+for name in "$@"; do
+	mkdir -p "$WORK/$name"
+	(cd "$WORK/$name" && timeout 120 "$SIM" "$DIR/$name.in" < "$DIR/$name.cmd" > output 2>&1
+		if [ -f "$DIR/$name.sh" ]; then sh "$DIR/$name.sh" >> output 2>&1; fi)
+	missing=$(awk 'BEGIN { n = k = 0 }
+		NR == FNR { want[n++] = $0; next }
+		k < n && $0 == want[k] { k++ }
+		END { for (; k < n; k++) print want[k] }' "$DIR/$name.expect" "$WORK/$name/output")
+	if [ -z "$missing" ]; then
+		echo "PASS $name"
+		pass=$((pass + 1))
+	else
+		echo "FAIL $name, not found (in order):"
+		printf '%s\n' "$missing" | sed 's/^/    /'
+		fail=$((fail + 1))
+	fi
+done
+
+rm -rf "$WORK"
+echo "$pass passed, $fail failed"
+[ $fail -eq 0 ]
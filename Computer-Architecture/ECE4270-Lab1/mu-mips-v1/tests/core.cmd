@@ -0,0 +1,5 @@
+trace
+sim
+rdump
+stats
+q
@@ -0,0 +1,5 @@
+trace
+sim
+rdump
+ff stats
+q
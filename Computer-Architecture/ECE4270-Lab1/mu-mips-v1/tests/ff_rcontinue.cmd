@@ -0,0 +1,11 @@
+trace
+journal 1
+sim
+break 0x00400008
+rstep 3000000000
+rdump
+break 0x00400008
+break 0x00400000
+rcontinue
+rdump
+q
@@ -0,0 +1,11 @@
+trace
+journal on
+sim
+rdump
+rstep 3000000000
+rdump
+rstep 2
+rdump
+sim
+rdump
+q
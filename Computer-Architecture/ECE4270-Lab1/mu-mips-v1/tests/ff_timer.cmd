@@ -0,0 +1,10 @@
+trace
+ff off
+sim
+rdump
+reset
+ff on
+sim
+rdump
+ff stats
+q
@@ -0,0 +1,11 @@
+trace
+fpu auto
+sim
+rdump
+reset
+fpu strict
+input 22 1
+sim
+rdump
+fpu regs
+q
@@ -0,0 +1,3 @@
+trace
+fuzz 2 2
+q
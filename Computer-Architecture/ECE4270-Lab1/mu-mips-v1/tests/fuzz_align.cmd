@@ -0,0 +1,4 @@
+trace
+sim
+rdump
+q
@@ -0,0 +1,5 @@
+trace
+ooo on
+interval 200 4
+rdump
+q
@@ -0,0 +1,4 @@
+trace
+interval 100 2
+rdump
+q
@@ -0,0 +1,16 @@
+trace
+rstep 1
+journal on
+sim
+rdump
+mdump 0x10010000 0x10010010
+rstep 100
+rdump
+mdump 0x10010000 0x10010010
+break 0x0040001c
+rcontinue
+rdump
+mdump 0x10010000 0x10010010
+run 1
+mdump 0x10010000 0x10010010
+q
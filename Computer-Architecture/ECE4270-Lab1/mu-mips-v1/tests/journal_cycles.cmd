@@ -0,0 +1,11 @@
+trace
+ooo on
+journal 1
+sim
+rdump
+rstep 150000
+rdump
+reset
+run 450005
+rdump
+q
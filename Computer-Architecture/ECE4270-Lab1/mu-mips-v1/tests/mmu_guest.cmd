@@ -0,0 +1,8 @@
+trace
+mmu on
+run 32
+mmu guest
+sim
+rdump
+mmu stats
+q
@@ -0,0 +1,6 @@
+trace
+ooo on
+sim
+rdump
+ooo stats
+q
@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+# Assembles the guest programs used by `make check` into <name>.in (one hex word per line).
+# Each program has a <name>.cmd fed to the simulator and a <name>.expect listing lines
+# its output must contain, in order. Re-run after editing a program: python3 programs.py
+import os
+
+# instruction encoders; registers are numbers, branch offsets count words from the branch
+def r_type(func, rd, rs, rt, sa=0): return rs << 21 | rt << 16 | rd << 11 | sa << 6 | func
+def i_type(op, rt, rs, imm): return op << 26 | rs << 21 | rt << 16 | (imm & 0xFFFF)
+
+def addu(rd, rs, rt): return r_type(0x21, rd, rs, rt)
+def subu(rd, rs, rt): return r_type(0x23, rd, rs, rt)
+def and_(rd, rs, rt): return r_type(0x24, rd, rs, rt)
+def or_(rd, rs, rt): return r_type(0x25, rd, rs, rt)
+def xor(rd, rs, rt): return r_type(0x26, rd, rs, rt)
+def sll(rd, rt, sa): return r_type(0x00, rd, 0, rt, sa)
+def srl(rd, rt, sa): return r_type(0x02, rd, 0, rt, sa)
+def mult(rs, rt): return r_type(0x18, 0, rs, rt)
+def mflo(rd): return r_type(0x12, rd, 0, 0)
+def addiu(rt, rs, imm): return i_type(0x09, rt, rs, imm)
+def andi(rt, rs, imm): return i_type(0x0C, rt, rs, imm)
+def ori(rt, rs, imm): return i_type(0x0D, rt, rs, imm)
+def lui(rt, imm): return i_type(0x0F, rt, 0, imm)
+def lw(rt, rs, imm): return i_type(0x23, rt, rs, imm)
+def sw(rt, rs, imm): return i_type(0x2B, rt, rs, imm)
+def lh(rt, rs, imm): return i_type(0x21, rt, rs, imm)
+def beq(rs, rt, off): return i_type(0x04, rt, rs, off)
+def bne(rs, rt, off): return i_type(0x05, rt, rs, off)
+def bgtz(rs, off): return i_type(0x07, 0, rs, off)
+
+# coprocessor 0
+def mfc0(rt, rd): return 0x40000000 | rt << 16 | rd << 11
+def mtc0(rt, rd): return 0x40800000 | rt << 16 | rd << 11
+TLBWR = 0x42000006
+ERET = 0x42000018
+ENTRYLO0, ENTRYLO1, BADVADDR, COUNT, COMPARE, STATUS, CAUSE, EPC = 2, 3, 8, 9, 11, 12, 13, 14
+
+# coprocessor 1; fmt S, D or W
+S, D, W = 0x10, 0x11, 0x14
+def mtc1(rt, fs): return 0x44800000 | rt << 16 | fs << 11
+def mfc1(rt, fs): return 0x44000000 | rt << 16 | fs << 11
+def ctc1(rt, fs): return 0x44C00000 | rt << 16 | fs << 11
+def cfc1(rt, fs): return 0x44400000 | rt << 16 | fs << 11
+def fop(fmt, func, fd, fs, ft=0): return 0x44000000 | fmt << 21 | ft << 16 | fs << 11 | fd << 6 | func
+def add_fmt(fmt, fd, fs, ft): return fop(fmt, 0x00, fd, fs, ft)
+def sub_fmt(fmt, fd, fs, ft): return fop(fmt, 0x01, fd, fs, ft)
+def mul_fmt(fmt, fd, fs, ft): return fop(fmt, 0x02, fd, fs, ft)
+def div_fmt(fmt, fd, fs, ft): return fop(fmt, 0x03, fd, fs, ft)
+def sqrt_fmt(fmt, fd, fs): return fop(fmt, 0x04, fd, fs)
+def cvt_s(fmt, fd, fs): return fop(fmt, 0x20, fd, fs)
+def cvt_d(fmt, fd, fs): return fop(fmt, 0x21, fd, fs)
+def cvt_w(fmt, fd, fs): return fop(fmt, 0x24, fd, fs)
+def round_w(fmt, fd, fs): return fop(fmt, 0x0C, fd, fs)
+def trunc_w(fmt, fd, fs): return fop(fmt, 0x0D, fd, fs)
+def floor_w(fmt, fd, fs): return fop(fmt, 0x0F, fd, fs)
+def c_eq(fmt, fs, ft): return fop(fmt, 0x32, 0, fs, ft)
+def c_lt(fmt, fs, ft): return fop(fmt, 0x3C, 0, fs, ft)
+# FCSR: Cause << 12 | Enables << 7 | Flags << 2 | RM, with I, U, O, Z, V = 1, 2, 4, 8, 0x10
+RN, RZ, RP, RM = 0, 1, 2, 3
+FPE_I, FPE_U, FPE_O, FPE_Z, FPE_V = 0x01, 0x02, 0x04, 0x08, 0x10
+def fcsr(rm=RN, fpe=0, enables=0, c=0): return c << 23 | fpe << 12 | enables << 7 | fpe << 2 | rm
+
+SYSCALL = 0x0000000C
+NOP = 0x00000000
+
+# load a 32-bit constant
+def li(rt, value): return [lui(rt, value >> 16 & 0xFFFF), ori(rt, rt, value & 0xFFFF)]
+
+# exit through syscall 10
+EXIT = [addiu(2, 0, 10), SYSCALL]
+
+# store <words> at <address> (kseg0 is unmapped, so this works before a handler exists)
+def poke(address, words):
+	code = li(8, address)
+	for i, word in enumerate(words):
+		code += li(9, word) + [sw(9, 8, 4 * i)] if word else [sw(0, 8, 4 * i)]
+	return code
+
+PROGRAMS = {}
+
+def program(name):
+	def register(build):
+		PROGRAMS[name] = build
+		return build
+	return register
+
+# core: a counted loop summing 1..10 and a multiply
+@program('core')
+def core():
+	return [addiu(8, 0, 10), addiu(9, 0, 0),
+		addu(9, 9, 8), addiu(8, 8, -1), bgtz(8, -2),
+		addiu(10, 0, 7), mult(9, 10), mflo(11)] + EXIT
+
+# fuzz: loads from $a0 plus the low bits of the first input word, so most mutations of the
+# empty seed make one unaligned crash site
+@program('fuzz')
+def fuzz():
+	return [andi(10, 6, 3), addu(9, 4, 10), lw(8, 9, 0)] + EXIT
+
+# fuzz_align: unaligned accesses are faults that neither load nor store
+@program('fuzz_align')
+def fuzz_align():
+	return [lui(9, 0x1001)] + li(10, 0xAABBCCDD) + [sw(10, 9, 2), lw(11, 9, 0), lw(12, 9, 4)] + \
+		li(13, 0x12345678) + [lw(13, 9, 1), addiu(14, 0, 0x77), lh(14, 9, 3)] + EXIT
+
+# ooo_fmtd: a chain of single-precision adds into $f1 (the high half of the double $f0),
+# then a chain of double adds that reads $f0; the second chain has to wait for the first
+@program('ooo_fmtd')
+def ooo_fmtd():
+	return [lui(8, 0x3F80), mtc1(8, 3), mtc1(0, 0), mtc1(0, 1), mtc1(0, 6), mtc1(0, 7)] + \
+		[add_fmt(S, 1, 1, 3)] * 6 + [add_fmt(D, 4, 0, 6)] + [add_fmt(D, 4, 4, 6)] * 6 + \
+		[mfc1(9, 1), mfc1(10, 5)] + EXIT
+
+# journal: 50 iterations storing the counter to a fixed word and to a word that rotates
+# through four slots, for reverse stepping across memory writes
+@program('journal')
+def journal():
+	return [lui(9, 0x1001), addiu(12, 0, 50),
+		addiu(8, 8, 1), sw(8, 9, 0), sll(10, 8, 2), andi(10, 10, 12), addu(11, 9, 10), sw(8, 11, 4),
+		bne(8, 12, -6)] + EXIT
+
+# journal_cycles: 100000 trips folding the counter page's cycle count into $t3; with the
+# timing model on, reverse stepping must still land where a plain run does
+@program('journal_cycles')
+def journal_cycles():
+	return [lui(13, 0xFFFF)] + li(8, 100000) + [lw(14, 13, 8), addu(11, 11, 14), sll(15, 11, 3),
+		xor(11, 11, 15), addiu(8, 8, -1), bgtz(8, -5)] + EXIT
+
+# mmu_handler: the general exception handler starts with a nop, so its first word is zero;
+# a timer interrupt must still reach it rather than be reported as unhandled
+@program('mmu_handler')
+def mmu_handler():
+	handler = [NOP, addiu(5, 0, 0x55)] + EXIT
+	return poke(0x80000180, handler) + li(10, 0x28) + [mtc0(10, COMPARE)] + \
+		li(10, 0x8001) + [mtc0(10, STATUS), beq(0, 0, 0)]
+
+# mmu_guest: install an identity-mapping refill handler (counting refills in $k1), then
+# touch 16 data pages; run the first part with `mmu on` and the rest with `mmu guest`
+MMU_GUEST_SETUP = 32
+@program('mmu_guest')
+def mmu_guest():
+	refill = [mfc0(26, BADVADDR), srl(26, 26, 13), sll(26, 26, 7), ori(26, 26, 0x3F), mtc0(26, ENTRYLO0),
+		addiu(26, 26, 0x40), mtc0(26, ENTRYLO1), TLBWR, addiu(27, 27, 1), ERET]
+	setup = poke(0x80000000, refill)
+	assert len(setup) == MMU_GUEST_SETUP
+	return setup + [addiu(8, 0, 0), lui(9, 0x1001), addiu(12, 0, 16),
+		sw(8, 9, 0), lw(10, 9, 0), addu(11, 11, 10), addiu(8, 8, 1), lui(13, 0), ori(13, 13, 0x1000),
+		addu(9, 9, 13), bne(8, 12, -7)] + EXIT
+
+# interval: 300 iterations of a three-instruction loop, then a read of the cycle counter,
+# which is architectural, so the timing model doesn't change what the guest sees
+@program('interval')
+def interval():
+	return [addiu(8, 0, 300), addu(9, 9, 8), addiu(8, 8, -1), bgtz(8, -2),
+		lui(13, 0xFFFF), lw(14, 13, 8), lw(15, 13, 0)] + EXIT
+
+# interval_spin: a loop that can never exit, with interrupts off
+@program('interval_spin')
+def interval_spin():
+	return [addiu(8, 0, 5), addiu(8, 8, -1), bgtz(8, -1), beq(0, 0, 0)] + EXIT
+
+# ff_bne: BNE loops whose trip counts need the modular inverse of the step:
+# 3k == 1 (k = 0xAAAAAAAB), then 4 + 6k == 2 with the counter wrapping twice
+# (k = 0x55555555), then 1 + 2k == 2, which never happens
+@program('ff_bne')
+def ff_bne():
+	return [addiu(10, 0, 1), addiu(8, 8, 3), addiu(9, 9, 5), bne(8, 10, -2),
+		addiu(11, 0, 4), addiu(12, 0, 2), addiu(11, 11, 6), addiu(13, 13, 1), bne(11, 12, -2),
+		addiu(14, 0, 2), addiu(15, 0, 1), addiu(15, 15, 2), bne(15, 14, -1)] + EXIT
+
+# ff_rstep: 2^32 trips of a three-instruction loop until the counter wraps to zero,
+# fast-forwarded with the journal on so rstep has to cross the skip
+@program('ff_rstep')
+def ff_rstep():
+	return [addiu(9, 0, 7), addiu(8, 8, 1), addiu(9, 9, 3), bne(8, 0, -2)] + EXIT
+
+# ff_rcontinue: a 2^32-trip loop that fast-forwards, then 100000 trips storing to memory,
+# which fill a small journal; rcontinue back to the first instruction has to replay
+# checkpoint intervals across the skipped loop
+@program('ff_rcontinue')
+def ff_rcontinue():
+	return [lui(9, 0x1001), addiu(8, 8, 1), addiu(10, 10, 3), bne(8, 0, -2)] + li(8, 100000) + \
+		[sw(8, 9, 0), addiu(8, 8, -1), bgtz(8, -2)] + EXIT
+
+# perf_ff: the host counter report normalizes by the instructions actually simulated,
+# not the 2^32 trips of ff_rstep's loop that fast-forward skips
+@program('perf_ff')
+def perf_ff():
+	return ff_rstep()
+
+# ff_timer: the Count/Compare interrupt falls in the middle of a 100000-trip loop; the
+# handler counts itself in $s0, records EPC in $s1 and clears Compare
+@program('ff_timer')
+def ff_timer():
+	handler = [addiu(16, 16, 1), mfc0(17, EPC), mtc0(0, COMPARE), ERET]
+	return poke(0x80000180, handler) + li(10, 0x2000) + [mtc0(10, COMPARE)] + \
+		li(10, 0x8001) + [mtc0(10, STATUS), addiu(9, 0, 0)] + li(8, 100000) + \
+		[addiu(9, 9, 2), addiu(8, 8, -1), bgtz(8, -2)] + EXIT
+
+# fpu_vectors: each vector sets FCSR, loads operands into $f0/$f2 (pairs for doubles), runs
+# one instruction into $f4 and compares $f4 and FCSR with the expected bits; a mismatch
+# sets bit i % 16 of $s5, $s7 or $t9 for vector i. FCSR is compared under the mask in $s0:
+# RM, Flags, Enables and C normally, Cause as well when $s6 is set (`input 22 1`), for the
+# strict path, since the fast path leaves Cause stale
+ONE_S, TWO_S, THREE_S, HALF_S, INF_S = 0x3F800000, 0x40000000, 0x40400000, 0x3F000000, 0x7F800000
+QNAN_S, SNAN_S, NAN_S = 0x7F812345, 0x7FC00000, 0x7FBFFFFF
+ONE_D, THREE_D, NAN_D = (0, 0x3FF00000), (0, 0x40080000), (0xFFFFFFFF, 0x7FF7FFFF)
+FPU_VECTORS = [
+	# (FCSR before, operands, instruction, expected $f4 words, expected FCSR)
+	(fcsr(), {0: ONE_S, 2: TWO_S}, add_fmt(S, 4, 0, 2), [THREE_S], fcsr()),
+	# 1/3 in each rounding mode, and -1/3 where the directed modes round the other way
+	(fcsr(RN), {0: ONE_S, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0x3EAAAAAB], fcsr(RN, FPE_I)),
+	(fcsr(RZ), {0: ONE_S, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0x3EAAAAAA], fcsr(RZ, FPE_I)),
+	(fcsr(RP), {0: ONE_S, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0x3EAAAAAB], fcsr(RP, FPE_I)),
+	(fcsr(RM), {0: ONE_S, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0x3EAAAAAA], fcsr(RM, FPE_I)),
+	(fcsr(RP), {0: 0xBF800000, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0xBEAAAAAA], fcsr(RP, FPE_I)),
+	(fcsr(RM), {0: 0xBF800000, 2: THREE_S}, div_fmt(S, 4, 0, 2), [0xBEAAAAAB], fcsr(RM, FPE_I)),
+	# Invalid: the result is the default NaN
+	(fcsr(), {0: 0, 2: 0}, div_fmt(S, 4, 0, 2), [NAN_S], fcsr(RN, FPE_V)),
+	(fcsr(), {0: 0xBF800000}, sqrt_fmt(S, 4, 0), [NAN_S], fcsr(RN, FPE_V)),
+	(fcsr(), {0: INF_S, 2: INF_S}, sub_fmt(S, 4, 0, 2), [NAN_S], fcsr(RN, FPE_V)),
+	(fcsr(), {0: ONE_S, 2: 0}, div_fmt(S, 4, 0, 2), [INF_S], fcsr(RN, FPE_Z)),
+	# NaN operands: a signalling NaN (top fraction bit set on MIPS) is Invalid, a quiet one is not
+	(fcsr(), {0: SNAN_S, 2: ONE_S}, add_fmt(S, 4, 0, 2), [NAN_S], fcsr(RN, FPE_V)),
+	(fcsr(), {0: QNAN_S, 2: ONE_S}, add_fmt(S, 4, 0, 2), [NAN_S], fcsr()),
+	(fcsr(), {0: QNAN_S, 2: ONE_S}, c_eq(S, 0, 2), [], fcsr()),
+	(fcsr(), {0: QNAN_S, 2: ONE_S}, c_lt(S, 0, 2), [], fcsr(RN, FPE_V)),
+	(fcsr(), {0: ONE_S, 2: ONE_S}, c_eq(S, 0, 2), [], fcsr(c=1)),
+	# denormals are kept, not flushed; Underflow only when tiny and inexact
+	(fcsr(), {0: 0x00000001, 2: HALF_S}, mul_fmt(S, 4, 0, 2), [0], fcsr(RN, FPE_U | FPE_I)),
+	(fcsr(), {0: 0x00800000, 2: HALF_S}, mul_fmt(S, 4, 0, 2), [0x00400000], fcsr()),
+	(fcsr(), {0: 0x00000001, 2: 0x00000001}, add_fmt(S, 4, 0, 2), [0x00000002], fcsr()),
+	(fcsr(), {0: 0x00000001}, cvt_d(S, 4, 0), [0, 0x36A00000], fcsr()),
+	# overflow rounds to infinity or to the largest finite value, by mode
+	(fcsr(RN), {0: 0x7F7FFFFF, 2: TWO_S}, mul_fmt(S, 4, 0, 2), [INF_S], fcsr(RN, FPE_O | FPE_I)),
+	(fcsr(RZ), {0: 0x7F7FFFFF, 2: TWO_S}, mul_fmt(S, 4, 0, 2), [0x7F7FFFFF], fcsr(RZ, FPE_O | FPE_I)),
+	(fcsr(RM), {0: 0x7F7FFFFF, 2: TWO_S}, mul_fmt(S, 4, 0, 2), [0x7F7FFFFF], fcsr(RM, FPE_O | FPE_I)),
+	# conversions to word: CVT.W follows FCSR.RM, ROUND/FLOOR ignore it; NaN and out of range are Invalid
+	(fcsr(RN), {0: 0x40200000}, cvt_w(S, 4, 0), [2], fcsr(RN, FPE_I)),
+	(fcsr(RN), {0: 0x40600000}, cvt_w(S, 4, 0), [4], fcsr(RN, FPE_I)),
+	(fcsr(RM), {0: 0xC0200000}, round_w(S, 4, 0), [0xFFFFFFFE], fcsr(RM, FPE_I)),
+	(fcsr(RN), {0: 0xBF000000}, floor_w(S, 4, 0), [0xFFFFFFFF], fcsr(RN, FPE_I)),
+	(fcsr(), {0: 0x4F32D05E}, cvt_w(S, 4, 0), [0x7FFFFFFF], fcsr(RN, FPE_V)),
+	(fcsr(), {0: QNAN_S}, trunc_w(S, 4, 0), [0x7FFFFFFF], fcsr(RN, FPE_V)),
+	# doubles
+	(fcsr(RN), {0: ONE_D, 2: THREE_D}, div_fmt(D, 4, 0, 2), [0x55555555, 0x3FD55555], fcsr(RN, FPE_I)),
+	(fcsr(RP), {0: ONE_D, 2: THREE_D}, div_fmt(D, 4, 0, 2), [0x55555556, 0x3FD55555], fcsr(RP, FPE_I)),
+	(fcsr(), {0: (0, 0xBFF00000)}, sqrt_fmt(D, 4, 0), list(NAN_D), fcsr(RN, FPE_V)),
+	(fcsr(), {0: (0, 0x7FF80000), 2: ONE_D}, add_fmt(D, 4, 0, 2), list(NAN_D), fcsr(RN, FPE_V)),
+	(fcsr(), {0: (1, 0x7FF00000), 2: ONE_D}, add_fmt(D, 4, 0, 2), list(NAN_D), fcsr()),
+	(fcsr(), {0: (0x2777579C, 0x37A16C26)}, cvt_s(D, 4, 0), [0x000116C2], fcsr(RN, FPE_U | FPE_I)),
+	(fcsr(), {0: (0, 0x00100000), 2: (0, 0x3FE00000)}, mul_fmt(D, 4, 0, 2), [0, 0x00080000], fcsr()),
+	# an enabled Invalid traps: Cause is set, Flags and $f4 are left alone; the handler counts in $t8
+	(fcsr(enables=FPE_V), {0: 0, 2: 0, 4: 0x12345678}, div_fmt(S, 4, 0, 2), [0x12345678],
+		fcsr(enables=FPE_V) | FPE_V << 12),
+]
+
+@program('fpu_vectors')
+def fpu_vectors():
+	handler = [addiu(24, 24, 1), mfc0(26, EPC), addiu(26, 26, 4), mtc0(26, EPC), ERET]
+	code = poke(0x80000180, handler) + li(16, 0x00800FFF) + [beq(22, 0, 3)] + li(16, 0x0083FFFF)
+	for i, (before, operands, instruction, result, after) in enumerate(FPU_VECTORS):
+		code += li(8, before) + [ctc1(8, 31)]
+		for f, value in operands.items():
+			for j, word in enumerate(value if isinstance(value, tuple) else (value,)):
+				code += li(9, word) + [mtc1(9, f + j)] if word else [mtc1(0, f + j)]
+		code += [instruction, cfc1(12, 31), addiu(15, 0, 0)]
+		for j, word in enumerate(result):
+			code += [mfc1(10, 4 + j)] + li(13, word) + [xor(13, 13, 10), or_(15, 15, 13)]
+		code += li(13, after) + [xor(13, 13, 12), and_(13, 13, 16), or_(15, 15, 13),
+			beq(15, 0, 2), ori((21, 23, 25)[i // 16], (21, 23, 25)[i // 16], 1 << i % 16)]
+	return code + EXIT
+
+# timer: a periodic interrupt re-arms Compare 100 Counts ahead and counts itself in $s0;
+# after ten, interrupts go off and a match only sets Cause.IP7 ($s6), which writing Compare
+# clears ($s7); MTC0 Count moves Count ($t8); then the counter page is written (which does
+# nothing) and read: instret, cycles, Count and Compare into $s1..$s5
+@program('timer')
+def timer():
+	handler = [addiu(16, 16, 1), mfc0(26, COUNT), addiu(26, 26, 100), mtc0(26, COMPARE), ERET]
+	return poke(0x80000180, handler) + \
+		[mfc0(10, COUNT), addiu(10, 10, 100), mtc0(10, COMPARE)] + li(11, 0x8001) + [mtc0(11, STATUS),
+		addiu(12, 0, 10), bne(16, 12, 0),
+		mtc0(0, STATUS), mfc0(10, COUNT), addiu(10, 10, 5), mtc0(10, COMPARE),
+		addiu(8, 0, 20), addiu(8, 8, -1), bgtz(8, -1), mfc0(22, CAUSE), mtc0(10, COMPARE), mfc0(23, CAUSE),
+		addiu(10, 0, 1000), mtc0(10, COUNT), NOP, NOP, NOP, NOP, mfc0(24, COUNT),
+		lui(13, 0xFFFF), sw(13, 13, 0), sw(13, 13, 8), lw(17, 13, 0), lw(18, 13, 4), lw(19, 13, 8),
+		lw(20, 13, 0x10), lw(21, 13, 0x14)] + EXIT
+
+# telemetry: write four data pages, then run a 2000000-trip loop (4000009 instructions in
+# all) long enough for a few telemetry records; run with ff off so the loop isn't skipped
+@program('telemetry')
+def telemetry():
+	return [lui(9, 0x1001)] + [sw(9, 9, 0x1000 * k) for k in range(4)] + li(8, 2000000) + \
+		[addiu(8, 8, -1), bgtz(8, -1)] + EXIT
+
+# telemetry_socket: a socket path that names an existing regular file is refused, not
+# deleted; a socket the simulator made is removed when telemetry stops
+@program('telemetry_socket')
+def telemetry_socket():
+	return core()
+
+# wcet: a counted loop that needs a user bound before the analysis has a finite answer
+@program('wcet')
+def wcet():
+	return core()
+
+# wcet_deep: 20000 diamonds in a row (a branch over one instruction): the CFG is too deep
+# to walk recursively and has 2^20000 paths, so the walk must be iterative and memoized
+@program('wcet_deep')
+def wcet_deep():
+	return [bne(8, 9, 2), addiu(10, 10, 1)] * 20000 + EXIT
+
+if __name__ == '__main__':
+	here = os.path.dirname(os.path.abspath(__file__))
+	for name, build in PROGRAMS.items():
+		with open(os.path.join(here, name + '.in'), 'w') as f:
+			f.write(''.join('%08X\n' % w for w in build()))
@@ -0,0 +1,7 @@
+trace
+ff off
+telemetry file telemetry.log 5
+sim
+rdump
+telemetry off
+q
@@ -0,0 +1,19 @@
+# telemetry.log: records numbered from 0, instruction counts that never go backwards or
+# pass the run's total, PCs inside the program or just past its exit; the loaded text page
+# and the four stored pages are dirty by the end
+awk '{
+	for (i = 1; i <= NF; i++) {
+		split($i, kv, "=")
+		f[kv[1]] = kv[2]
+	}
+	if (f["seq"] != NR - 1 || f["insts"] + 0 < insts || f["insts"] + 0 > 4000009 ||
+		f["pc"] < "0x00400000" || f["pc"] > "0x0040002c" || (f["running"] != 0 && f["running"] != 1)) {
+		print "bad record: " $0
+		bad++
+	}
+	insts = f["insts"] + 0
+}
+END {
+	if (NR > 1 && !bad) print "telemetry.log: records consistent"
+	print "last record: dirty=" f["dirty"] " hot=" f["hot"]
+}' telemetry.log
@@ -0,0 +1,7 @@
+trace
+telemetry file results.log 100
+telemetry off
+telemetry socket results.log 100
+telemetry socket telemetry.sock 100
+telemetry off
+q
@@ -0,0 +1,3 @@
+# results.log must still be the regular file telemetry created; telemetry.sock must be gone
+[ -f results.log ] && echo "results.log kept"
+[ -e telemetry.sock ] || echo "telemetry.sock removed"
@@ -0,0 +1,8 @@
+trace
+sim
+rdump
+reset
+ooo on
+sim
+rdump
+q
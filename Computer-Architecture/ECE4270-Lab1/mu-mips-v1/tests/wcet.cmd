@@ -0,0 +1,8 @@
+trace
+wcet report
+wcet bound 0x00400008 10
+wcet report
+ooo on
+sim
+ooo stats
+q
@@ -0,0 +1,5 @@
+trace
+wcet report
+sim
+rdump
+q